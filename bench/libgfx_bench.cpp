@@ -0,0 +1,433 @@
+#include "../include/libGfx.h"
+#include "../include/libGfxEvent.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 无窗口基准：渲染、文字、资源加载与事件分发热路径
+//
+// 用法: libgfx_bench [--out results.json] [--font path.ttf] [--filter substr]
+//                    [--min-time ms]
+//
+// 默认使用 SDL offscreen 视频驱动（EGL，配合 Mesa llvmpipe 可在 CI 中运行）；
+// 设置 SDL_VIDEODRIVER 可覆盖。结果以 JSON 写入 --out（缺省为标准输出）。
+
+// ================ 分配计数 ================
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string out;
+    std::string font = "/usr/share/fonts/truetype/ubuntu/Ubuntu-B.ttf";
+    std::string filter;
+    double minTimeMs = 200.0;
+};
+
+struct Result {
+    std::string name;
+    size_t scale = 0;         // 工作量参数：绘制数、字号、图片边长、监听器数
+    uint64_t iterations = 0;
+    double nsPerOp = 0.0;
+    double opsPerSec = 0.0;   // 绘制类用例即 draws/sec
+    double allocsPerOp = 0.0;
+    uint32_t drawCallsPerIter = 0;  // 绘制类用例每帧的 draw call 数（含非批处理绘制）
+};
+
+Options g_options;
+std::vector<Result> g_results;
+
+bool Selected(const std::string& name)
+{
+    return g_options.filter.empty() || name.find(g_options.filter) != std::string::npos;
+}
+
+// 预热一次后重复 body 直到累计时间超过 minTimeMs；body 每次执行 opsPerIter
+// 个操作，gpu 用例在计时结束前 glFinish，避免只测到命令入队
+void Run(const std::string& name, size_t scale, size_t opsPerIter,
+         const std::function<void()>& body, bool gpu = false)
+{
+    if (!Selected(name)) return;
+
+    body();
+    if (gpu) glFinish();
+    const uint32_t drawCalls = gpu ? gfx::Renderer::GetBatchStats().drawCalls : 0;
+
+    uint64_t iterations = 0;
+    const uint64_t allocsBefore = g_allocations.load(std::memory_order_relaxed);
+    const Clock::time_point start = Clock::now();
+    double elapsedMs = 0.0;
+    do {
+        body();
+        ++iterations;
+        if (gpu && (iterations & 7) == 0) glFinish();
+        elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    } while (elapsedMs < g_options.minTimeMs);
+    if (gpu) glFinish();
+    elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    const uint64_t allocs = g_allocations.load(std::memory_order_relaxed) - allocsBefore;
+
+    Result r;
+    r.name = name;
+    r.scale = scale;
+    r.iterations = iterations;
+    const double ops = static_cast<double>(iterations) * static_cast<double>(opsPerIter);
+    r.nsPerOp = elapsedMs * 1e6 / ops;
+    r.opsPerSec = ops / (elapsedMs / 1000.0);
+    r.allocsPerOp = static_cast<double>(allocs) / ops;
+    r.drawCallsPerIter = drawCalls;
+    g_results.push_back(r);
+
+    std::fprintf(stderr, "%-24s %8zu %12.1f ns/op %14.0f op/s %8.3f alloc/op\n",
+                 name.c_str(), scale, r.nsPerOp, r.opsPerSec, r.allocsPerOp);
+}
+
+// 一帧：清屏、draw、提交
+void Frame(const std::function<void()>& draw)
+{
+    gfx::Renderer::Clear(gfx::Black);
+    draw();
+    gfx::Renderer::Present();
+}
+
+gfx::Point GridPoint(size_t i)
+{
+    return gfx::Point(static_cast<float>(i % 100) * 10.0f,
+                      static_cast<float>(i / 100 % 76) * 10.0f);
+}
+
+// ================ 渲染 ================
+void BenchDraws(gfx::Texture* texture)
+{
+    for (size_t n : {100u, 1000u, 10000u}) {
+        // 批处理默认关闭：每个用例分别测直接绘制与批处理两条路径
+        for (bool batched : {false, true}) {
+            const std::string suffix = batched ? "_batched" : "";
+            gfx::Renderer::SetBatching(batched);
+
+            Run("draw_rect" + suffix, n, n, [n] {
+                Frame([n] {
+                    for (size_t i = 0; i < n; ++i) {
+                        const gfx::Point p = GridPoint(i);
+                        gfx::Renderer::DrawRect(gfx::Rect(p.x, p.y, 8.0f, 8.0f),
+                                                gfx::Color(static_cast<uint8_t>(i), 128, 255));
+                    }
+                });
+            }, true);
+
+            Run("draw_texture" + suffix, n, n, [n, texture] {
+                Frame([n, texture] {
+                    for (size_t i = 0; i < n; ++i) {
+                        const gfx::Point p = GridPoint(i);
+                        gfx::Renderer::DrawTexture(texture, gfx::Rect(p.x, p.y, 8.0f, 8.0f));
+                    }
+                });
+            }, true);
+        }
+        gfx::Renderer::SetBatching(false);
+
+        Run("draw_line", n, n, [n] {
+            Frame([n] {
+                for (size_t i = 0; i < n; ++i) {
+                    const gfx::Point p = GridPoint(i);
+                    gfx::Renderer::DrawLine(p, gfx::Point(p.x + 9.0f, p.y + 7.0f),
+                                            gfx::White, 2.0f);
+                }
+            });
+        }, true);
+
+        std::vector<gfx::RectInstance> cells;
+        cells.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            const gfx::Point p = GridPoint(i);
+            cells.push_back({gfx::Rect(p.x, p.y, 8.0f, 8.0f),
+                             gfx::Color(static_cast<uint8_t>(i), 128, 255)});
+        }
+        Run("draw_rects_instanced", n, n, [&cells] {
+            Frame([&cells] { gfx::Renderer::DrawRectsInstanced(cells); });
+        }, true);
+    }
+}
+
+// ================ 文字 ================
+void BenchText()
+{
+    const char* text = "The quick brown fox 0123456789";
+    gfx::Font* font = gfx::Font::Load(g_options.font, 18, gfx::White);
+    gfx::FontA* fonta = gfx::FontA::Load(g_options.font, 18);
+    if (!font || !fonta) {
+        std::fprintf(stderr, "font %s unavailable, skipping text cases\n",
+                     g_options.font.c_str());
+    }
+
+    for (size_t n : {10u, 100u, 1000u}) {
+        if (font) {
+            Run("draw_text_font", n, n, [n, font, text] {
+                Frame([n, font, text] {
+                    for (size_t i = 0; i < n; ++i)
+                        gfx::Renderer::DrawText(text, GridPoint(i * 37), font);
+                });
+            }, true);
+        }
+        if (fonta) {
+            Run("draw_text_fonta", n, n, [n, fonta, text] {
+                Frame([n, fonta, text] {
+                    for (size_t i = 0; i < n; ++i)
+                        gfx::Renderer::DrawText(text, GridPoint(i * 37), fonta, gfx::White);
+                });
+            }, true);
+        }
+    }
+
+    if (fonta) gfx::FontA::Release(fonta);
+    if (!font) return;
+    gfx::Font::Release(font);
+
+    for (int size : {16, 32, 64}) {
+        Run("font_load", static_cast<size_t>(size), 1, [size] {
+            if (gfx::Font* f = gfx::Font::Load(g_options.font, size, gfx::White))
+                gfx::Font::Release(f);
+        });
+    }
+}
+
+// ================ 纹理加载 ================
+void BenchLoadTexture(const std::filesystem::path& dir)
+{
+    // 关闭缓存保留，Release 后下一次 Load 重新解码上传
+    gfx::Renderer::SetTextureCacheRetain(false);
+
+    for (int size : {64, 256, 1024}) {
+        SDL_Surface* surface =
+            SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!surface) continue;
+        for (int y = 0; y < size; ++y) {
+            uint8_t* row = static_cast<uint8_t*>(surface->pixels) + y * surface->pitch;
+            for (int x = 0; x < size; ++x) {
+                row[x * 4 + 0] = static_cast<uint8_t>(x);
+                row[x * 4 + 1] = static_cast<uint8_t>(y);
+                row[x * 4 + 2] = static_cast<uint8_t>(x ^ y);
+                row[x * 4 + 3] = 255;
+            }
+        }
+        const std::string path = (dir / ("bench_" + std::to_string(size) + ".bmp")).string();
+        const bool saved = SDL_SaveBMP(surface, path.c_str()) == 0;
+        SDL_FreeSurface(surface);
+        if (!saved) continue;
+
+        Run("load_texture", static_cast<size_t>(size), 1, [path] {
+            gfx::Renderer::ReleaseTexture(gfx::Renderer::LoadTexture(path));
+        }, true);
+        std::filesystem::remove(path);
+    }
+}
+
+// ================ 事件分发 ================
+void BenchEvents()
+{
+    SDL_Event motion{};
+    motion.type = SDL_MOUSEMOTION;
+    motion.motion.x = 100;
+    motion.motion.y = 200;
+    motion.motion.xrel = 1;
+    motion.motion.yrel = -1;
+
+    // 按数量递增依次补齐监听器，最后统一移除
+    volatile uint64_t sink = 0;
+    std::vector<gfx::Event::ListenerHandle> handles;
+    for (size_t n : {1u, 10u, 100u}) {
+        while (handles.size() < n) {
+            handles.push_back(gfx::Event::AddListener(
+                gfx::Event::EventType::MouseMotion, [&sink](const gfx::Event::Event& e) {
+                    sink = sink + static_cast<uint64_t>(e.mouse.position.x);
+                }));
+        }
+        Run("event_dispatch", n, 1, [&motion] { gfx::Event::PollEvents(motion); });
+    }
+    const size_t listeners = handles.size();
+
+    // 合并模式：一帧内 16 个移动事件只派发一次
+    gfx::Event::SetMotionCoalescing(true);
+    Run("event_dispatch_coalesced", listeners, 16, [&motion] {
+        for (int i = 0; i < 16; ++i) gfx::Event::PollEvents(motion);
+        gfx::Event::DispatchPending();
+    });
+    gfx::Event::SetMotionCoalescing(false);
+
+    // 订阅与退订：槽位复用，回调内联存放，不应有堆分配
+    Run("event_subscribe", listeners, 1, [&sink] {
+        gfx::Event::RemoveListener(gfx::Event::AddListener(
+            gfx::Event::EventType::KeyDown,
+            [&sink](const gfx::Event::Event&) { sink = sink + 1; }));
+    });
+
+    // 回放：录制一段合成会话，再反复整段回放（解码 + 翻译 + 派发）
+    constexpr int kReplayEvents = 1024;
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "bench_input.gfxi").string();
+    if (gfx::Event::StartRecording(path)) {
+        for (int i = 0; i < kReplayEvents; ++i) {
+            motion.common.timestamp = static_cast<uint32_t>(i * 4);
+            motion.motion.x = i % 1024;
+            motion.motion.y = (i * 7) % 768;
+            gfx::Event::PollEvents(motion);
+        }
+        gfx::Event::StopRecording();
+    }
+    if (gfx::Event::InputReplay* replay = gfx::Event::InputReplay::Open(path)) {
+        Run("event_replay", listeners, kReplayEvents, [replay] {
+            replay->Rewind();
+            replay->DispatchAll();
+        });
+        delete replay;
+    }
+    std::filesystem::remove(path);
+
+    for (gfx::Event::ListenerHandle handle : handles) gfx::Event::RemoveListener(handle);
+
+    // 区域监听器：32x32 的控件铺满一片区域，光标在其上移动，每个控件都监听移动和进入
+    std::vector<gfx::Event::RegionHandle> regions;
+    for (size_t n : {100u, 1000u, 10000u}) {
+        const int columns = static_cast<int>(std::sqrt(static_cast<double>(n)));
+        for (size_t i = regions.size() / 2; i < n; ++i) {
+            const gfx::Rect rect(static_cast<int>(i % columns) * 32,
+                                 static_cast<int>(i / columns) * 32, 30, 30);
+            auto hit = [&sink](const gfx::Event::Event& e) {
+                sink = sink + static_cast<uint64_t>(e.mouse.position.y);
+            };
+            regions.push_back(gfx::Event::AddRegionListener(
+                rect, gfx::Event::EventType::MouseMotion, hit));
+            regions.push_back(gfx::Event::AddRegionListener(
+                rect, gfx::Event::EventType::MouseEnter, hit));
+        }
+        const int extent = columns * 32;
+        uint32_t step = 0;
+        Run("event_region_motion", n, 1, [&motion, &step, extent] {
+            ++step;
+            motion.motion.x = static_cast<int>(step * 13 % static_cast<uint32_t>(extent));
+            motion.motion.y = static_cast<int>(step * 7 % static_cast<uint32_t>(extent));
+            gfx::Event::PollEvents(motion);
+        });
+    }
+    for (gfx::Event::RegionHandle handle : regions) gfx::Event::RemoveRegionListener(handle);
+}
+
+// ================ 输出 ================
+std::string JsonEscape(const char* s)
+{
+    std::string out;
+    for (; s && *s; ++s) {
+        if (*s == '"' || *s == '\\') out += '\\';
+        if (static_cast<unsigned char>(*s) < 0x20) continue;
+        out += *s;
+    }
+    return out;
+}
+
+std::string ToJson()
+{
+    std::ostringstream os;
+    os << "{\n";
+    os << "  \"video_driver\": \"" << JsonEscape(SDL_GetCurrentVideoDriver()) << "\",\n";
+    os << "  \"gl_renderer\": \""
+       << JsonEscape(reinterpret_cast<const char*>(glGetString(GL_RENDERER))) << "\",\n";
+    os << "  \"gl_version\": \""
+       << JsonEscape(reinterpret_cast<const char*>(glGetString(GL_VERSION))) << "\",\n";
+    os << "  \"min_time_ms\": " << g_options.minTimeMs << ",\n";
+    os << "  \"results\": [";
+    for (size_t i = 0; i < g_results.size(); ++i) {
+        const Result& r = g_results[i];
+        os << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"scale\": "
+           << r.scale << ", \"iterations\": " << r.iterations
+           << ", \"ns_per_op\": " << r.nsPerOp << ", \"ops_per_sec\": " << r.opsPerSec
+           << ", \"allocs_per_op\": " << r.allocsPerOp
+           << ", \"draw_calls_per_iter\": " << r.drawCallsPerIter << "}";
+    }
+    os << "\n  ]\n}\n";
+    return os.str();
+}
+
+bool ParseArgs(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--out" && hasValue) g_options.out = argv[++i];
+        else if (arg == "--font" && hasValue) g_options.font = argv[++i];
+        else if (arg == "--filter" && hasValue) g_options.filter = argv[++i];
+        else if (arg == "--min-time" && hasValue) g_options.minTimeMs = std::atof(argv[++i]);
+        else {
+            std::fprintf(stderr,
+                         "Usage: libgfx_bench [--out file.json] [--font path.ttf] "
+                         "[--filter substr] [--min-time ms]\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (!ParseArgs(argc, argv)) return 2;
+
+    // 不覆盖调用方显式指定的驱动
+    if (!std::getenv("SDL_VIDEODRIVER")) SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+    if (GFX_INIT() != 0) return -1;
+
+    SDL_Window* window = SDL_CreateWindow(
+        "libgfx_bench",
+        SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+        1024, 768,
+        SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN
+    );
+    if (!window || !gfx::Renderer::Init(window)) {
+        std::cerr << "Init Failed: " << SDL_GetError() << std::endl;
+        return -1;
+    }
+    SDL_GL_SetSwapInterval(0);  // 不受垂直同步限速
+    gfx::Renderer::HandleWindowResize(1024, 768);
+
+    gfx::Texture* texture = gfx::Renderer::CreateTexture(32, 32);
+    BenchDraws(texture);
+    gfx::Renderer::ReleaseTexture(texture);
+    BenchText();
+    BenchLoadTexture(std::filesystem::temp_directory_path());
+    BenchEvents();
+
+    const std::string json = ToJson();
+    if (g_options.out.empty()) {
+        std::fputs(json.c_str(), stdout);
+    } else {
+        std::ofstream(g_options.out) << json;
+    }
+
+    gfx::Renderer::Shutdown();
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 0;
+}
@@ -33,12 +33,6 @@ int main(int argc, char* argv[]) {
         return -1;
     }
 
-    // 设置初始投影矩阵
-    int w, h;
-    SDL_GetWindowSize(window, &w, &h);
-    s_projection = glm::ortho(0.0f, (float)w, (float)h, 0.0f);
-    glViewport(0, 0, w, h);
-
     bool running = true;
     SDL_Event event;
 
@@ -0,0 +1,65 @@
+#include "../include/libGfx.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// 无窗口渲染：批量生成缩略图，第 N 帧的回读与第 N+1 帧的绘制重叠
+// 用法: example_headless [帧数] [输出目录]
+
+static void DrawThumbnail(int index, int w, int h)
+{
+    gfx::Renderer::Clear(gfx::Color(32, 32, 40));
+    for (int i = 0; i < 16; ++i) {
+        const float t = static_cast<float>(index * 16 + i);
+        gfx::Renderer::DrawRect(
+            gfx::Rect(std::fmod(t * 37.0f, static_cast<float>(w)),
+                      std::fmod(t * 23.0f, static_cast<float>(h)), 48.0f, 48.0f),
+            gfx::Color((i * 53) & 255, (index * 31) & 255, 200, 220));
+    }
+    gfx::Renderer::DrawLine(gfx::Point(0.0f, 0.0f),
+                            gfx::Point(static_cast<float>(w), static_cast<float>(h)),
+                            gfx::Yellow, 3.0f);
+}
+
+static void Save(const std::vector<uint8_t>& pixels, int w, int h, const std::string& path)
+{
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+        const_cast<uint8_t*>(pixels.data()), w, h, 32, w * 4, SDL_PIXELFORMAT_RGBA32);
+    if (!surface) return;
+    if (IMG_SavePNG(surface, path.c_str()) != 0)
+        std::cerr << "IMG_SavePNG Failed: " << IMG_GetError() << std::endl;
+    SDL_FreeSurface(surface);
+}
+
+int main(int argc, char* argv[]) {
+    const int frames = argc > 1 ? std::atoi(argv[1]) : 8;
+    const std::string outDir = argc > 2 ? argv[2] : ".";
+    const int w = 512, h = 512;
+
+    if (!gfx::Renderer::InitHeadless(w, h)) {
+        std::cerr << "InitHeadless Failed" << std::endl;
+        return -1;
+    }
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(w) * h * 4);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        DrawThumbnail(i, w, h);
+        gfx::Renderer::Present();
+        // 上一帧此时已下载完成，读取不会等待刚提交的这一帧
+        if (gfx::Renderer::PendingReadbacks() > 1 && gfx::Renderer::ReadPixels(pixels.data()))
+            Save(pixels, w, h, outDir + "/thumb_" + std::to_string(i - 1) + ".png");
+    }
+    if (gfx::Renderer::ReadPixels(pixels.data()))
+        Save(pixels, w, h, outDir + "/thumb_" + std::to_string(frames - 1) + ".png");
+    auto end = std::chrono::steady_clock::now();
+
+    std::printf("%d frames in %.1f ms\n", frames,
+                std::chrono::duration<double, std::milli>(end - start).count());
+
+    gfx::Renderer::Shutdown();
+    return 0;
+}
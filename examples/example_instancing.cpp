@@ -0,0 +1,66 @@
+#include "../include/libGfx.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// 对比逐个 DrawRect 与 DrawRectsInstanced 在不同实例数下的耗时
+// 用法: example_instancing [帧数]
+
+static double TimeFrames(int frames, const std::function<void()>& draw)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        gfx::Renderer::Clear(gfx::Black);
+        draw();
+        gfx::Renderer::Present();
+    }
+    glFinish();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+}
+
+int main(int argc, char* argv[]) {
+    GFX_INIT();
+    const int frames = argc > 1 ? std::atoi(argv[1]) : 10;
+
+    SDL_Window* window = SDL_CreateWindow(
+        "libGfx instancing",
+        SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+        1024, 768,
+        SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN
+    );
+    if (!window || !gfx::Renderer::Init(window)) {
+        std::cerr << "Init Failed: " << SDL_GetError() << std::endl;
+        return -1;
+    }
+
+    std::printf("%10s %16s %16s %10s\n", "instances", "DrawRect ms", "instanced ms", "speedup");
+    for (size_t count : {1000u, 10000u, 100000u}) {
+        // 生成网格状热力图单元
+        std::vector<gfx::RectInstance> cells;
+        cells.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            float x = static_cast<float>(i % 400) * 2.5f;
+            float y = static_cast<float>(i / 400 % 300) * 2.5f;
+            uint8_t v = static_cast<uint8_t>(i * 37);
+            cells.push_back({gfx::Rect(x, y, 2.0f, 2.0f), gfx::Color(v, 255 - v, 128)});
+        }
+
+        double perItem = TimeFrames(frames, [&] {
+            for (const gfx::RectInstance& c : cells)
+                gfx::Renderer::DrawRect(c.rect, c.color);
+        });
+        double instanced = TimeFrames(frames, [&] {
+            gfx::Renderer::DrawRectsInstanced(cells);
+        });
+        std::printf("%10zu %16.3f %16.3f %9.1fx\n", count, perItem, instanced,
+                    perItem / instanced);
+    }
+
+    gfx::Renderer::Shutdown();
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 0;
+}
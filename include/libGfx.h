@@ -21,6 +21,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <sstream>
@@ -31,8 +32,6 @@
 #include <stdexcept>
 #include <ft2build.h>
 #include FT_FREETYPE_H
-extern glm::mat4 s_projection;
-extern GLuint lineVAO, lineVBO;
 struct FontKey
 {
   std::string name;
@@ -149,23 +148,304 @@ struct Rect
 };
 
 struct Texture;
+struct SubTexture;
 class Font;
 class FontA;
 
+/// @brief Per-instance data for Renderer::DrawRectsInstanced
+/// @note Uploaded to the GPU as-is; keep the layout tightly packed
+struct RectInstance
+{
+  Rect rect;
+  Color color;
+};
+
+/// @brief Per-instance data for Renderer::DrawSpritesInstanced
+struct SpriteInstance
+{
+  Rect rect;
+  Rect uv = Rect(0.0f, 0.0f, 1.0f, 1.0f);  ///< Normalized (u, v, w, h)
+  Color color = Color(0xFFFFFFFF);        ///< Tint
+};
+
+/// @brief Blend equation applied to subsequent draws
+enum class BlendMode
+{
+  None,          ///< Blending disabled, source overwrites destination
+  Alpha,         ///< Classic SRC_ALPHA / ONE_MINUS_SRC_ALPHA (default);
+                 ///< destination alpha accumulates as ONE / ONE_MINUS_SRC_ALPHA
+  Additive,      ///< SRC_ALPHA / ONE, for glows and particles
+  Premultiplied  ///< ONE / ONE_MINUS_SRC_ALPHA, for Framebuffer contents
+};
+
+/// @brief Shape drawn where two polyline segments meet
+enum class LineJoin
+{
+  Miter,  ///< Sharp corner, falls back to Bevel beyond StrokeStyle::miterLimit
+  Bevel,  ///< Corner cut flat
+  Round   ///< Circular arc
+};
+
+/// @brief Shape drawn at the open ends of a polyline
+enum class LineCap
+{
+  Butt,    ///< Ends exactly at the endpoint
+  Square,  ///< Extends half the width past the endpoint
+  Round    ///< Semicircle around the endpoint
+};
+
+/// @brief Stroke parameters for Renderer::DrawPolyline
+struct StrokeStyle
+{
+  float width = 1.0f;
+  LineJoin join = LineJoin::Miter;
+  LineCap cap = LineCap::Butt;
+  float miterLimit = 4.0f;  ///< Max miter length in multiples of half width
+};
+
+/// @brief Why the quad batcher submitted its pending vertices
+enum class FlushReason
+{
+  TextureChange,  ///< Next quad samples a different texture
+  BlendChange,    ///< SetBlendMode changed the blend state
+  BufferFull,     ///< Vertex buffer reached its capacity
+  Present,        ///< End of frame
+  Interleave,     ///< A non-batched draw or state change needed the GPU
+  Explicit,       ///< Renderer::Flush() was called
+  Count
+};
+
+/// @brief Per-frame batcher statistics (see Renderer::GetBatchStats)
+struct BatchStats
+{
+  uint32_t flushes = 0;                                       ///< Batch draw calls issued
+  uint32_t flushReasons[static_cast<int>(FlushReason::Count)] = {};  ///< Flushes by reason
+  uint32_t quads = 0;                                         ///< Quads submitted
+  uint32_t vertices = 0;                                      ///< Vertices uploaded
+  uint32_t drawCalls = 0;                                     ///< All draw calls, batched or direct
+
+  uint32_t Flushes(FlushReason reason) const
+  {
+    return flushReasons[static_cast<int>(reason)];
+  }
+};
+
+/// @brief Upload strategy picked for the dynamic geometry ring buffer
+enum class StreamMode
+{
+  Persistent,      ///< glBufferStorage + persistent coherent mapping (GL 4.4 / ARB_buffer_storage)
+  Unsynchronized,  ///< glMapBufferRange(UNSYNCHRONIZED) guarded by fences
+  Orphan           ///< glBufferData orphaning + glBufferSubData (older GL)
+};
+
+/// @brief Per-frame dynamic geometry streaming counters
+///        (see Renderer::GetStreamStats)
+struct StreamStats
+{
+  StreamMode mode = StreamMode::Orphan;
+  uint64_t bytesStreamed = 0;  ///< Vertex/index/instance bytes written
+  uint32_t allocations = 0;
+  uint32_t wraps = 0;          ///< Times the write head wrapped to offset 0
+  uint32_t fenceWaits = 0;     ///< Allocations that blocked on an unsignaled fence
+  double fenceWaitMs = 0.0;    ///< Time spent blocked on fences
+};
+
+/// @brief Issued/skipped counts for one kind of GL state call
+struct GLCallStats
+{
+  uint64_t issued = 0;   ///< Calls that reached the driver
+  uint64_t skipped = 0;  ///< Redundant calls filtered by the state cache
+};
+
+/// @brief GL state cache counters (see Renderer::GetGLStateStats)
+struct GLStateStats
+{
+  GLCallStats program;      ///< glUseProgram
+  GLCallStats vertexArray;  ///< glBindVertexArray
+  GLCallStats texture;      ///< glActiveTexture + glBindTexture
+  GLCallStats blend;        ///< glEnable/glDisable(GL_BLEND) + glBlendFunc
+  GLCallStats framebuffer;  ///< glBindFramebuffer
+  GLCallStats uniform;      ///< glUniform*
+
+  uint64_t Issued() const
+  {
+    return program.issued + vertexArray.issued + texture.issued +
+           blend.issued + framebuffer.issued + uniform.issued;
+  }
+  uint64_t Skipped() const
+  {
+    return program.skipped + vertexArray.skipped + texture.skipped +
+           blend.skipped + framebuffer.skipped + uniform.skipped;
+  }
+};
+
+/// @brief How the renderer limits redraw to changed screen regions
+enum class DamageMode
+{
+  Off,     ///< Every frame is redrawn and presented (default)
+  Manual,  ///< Only regions passed to MarkDirty are redrawn (scissored, draws
+           ///< outside them are culled); Present is skipped if none was marked
+  Auto     ///< Draw calls are diffed against the previous frame; Present is
+           ///< skipped when nothing changed and nothing was marked dirty
+};
+
+/// @brief Damage tracking results of the last frame (see Renderer::GetDamageStats)
+struct DamageStats
+{
+  uint32_t rects = 0;           ///< Dirty rects marked / changed draws found
+  Rect bounds{0.0f, 0.0f, 0.0f, 0.0f};  ///< Redrawn region, screen coordinates
+  float damagedArea = 0.0f;     ///< Area of bounds
+  float screenArea = 0.0f;
+  uint32_t culledDraws = 0;     ///< Draws/glyphs skipped outside the damage
+  bool presented = true;        ///< False when Present skipped the swap
+  uint64_t skippedFrames = 0;   ///< Cumulative skipped presents
+};
+
+/// @brief Program binary disk cache counters (see Renderer::GetShaderCacheStats)
+struct ShaderCacheStats
+{
+  uint32_t hits = 0;      ///< Programs restored with glProgramBinary
+  uint32_t misses = 0;    ///< Programs compiled from source
+  uint32_t stores = 0;    ///< Binaries written to the cache
+  uint32_t rejected = 0;  ///< Cached binaries the driver refused (deleted)
+};
+
+/// @brief Worker and per-frame budget settings for Renderer::LoadTextureAsync
+struct AsyncLoadConfig
+{
+  int workerThreads = 0;                   ///< 0: hardware threads - 1, clamped to 1..4
+  size_t uploadBytesPerFrame = 8u << 20;   ///< Pixel bytes uploaded per frame
+  double uploadMsPerFrame = 2.0;           ///< CPU time spent uploading per frame
+  bool usePixelBuffer = true;              ///< Stage uploads through a PBO
+};
+
+/// @brief Asynchronous texture loading counters (see Renderer::GetAsyncLoadStats)
+struct AsyncLoadStats
+{
+  uint32_t decoding = 0;          ///< Queued or being decoded on workers
+  uint32_t awaitingUpload = 0;    ///< Decoded, waiting for the upload budget
+  uint32_t uploadedLastFrame = 0;
+  uint64_t bytesUploadedLastFrame = 0;
+  double uploadMsLastFrame = 0.0;
+  uint32_t failed = 0;            ///< Cumulative decode/upload failures
+};
+
+/// @brief Path-keyed texture cache counters (see Renderer::GetTextureCacheStats)
+struct TextureCacheStats
+{
+  uint64_t hits = 0;           ///< LoadTexture* calls served from the cache
+  uint64_t misses = 0;
+  uint32_t entries = 0;
+  uint32_t unreferenced = 0;   ///< Retained entries TrimTextureCache would free
+  size_t bytes = 0;            ///< RGBA8 size of the loaded entries
+};
+
 // ==================== Rendering Core ====================
 
+namespace internal
+{
+struct ContextState;
+struct TextureRecord;
+struct TextureAccess;
+}
+
+/// @brief GL context together with the renderer state bound to it: programs,
+///        buffers, batcher, GL state cache, projection, damage tracking and
+///        the headless target
+/// @note A context is current on at most one thread at a time, and every
+///       Renderer call acts on the calling thread's current context.
+///       Renderer::Init/InitHeadless create the default context, which also
+///       runs the async texture loader, the task queue and the profiler's
+///       GPU timers. Contexts created with @p shareWith see each other's
+///       textures (including the LoadTexture path cache) and fonts; VAOs
+///       and Framebuffers stay private to the context that created them.
+///       Font and FontA fill their caches while drawing, so a shared font
+///       must not be drawn from two threads at once.
+/// @code
+///   // 主线程：创建并交给工作线程
+///   RenderContext* worker =
+///       RenderContext::CreateHeadless(w, h, RenderContext::Current());
+///   std::thread([=] {
+///     RenderContext::MakeCurrent(worker);
+///     ... Renderer::Present(); Renderer::ReadPixels(buf); ...
+///     delete worker;
+///   });
+/// @endcode
+class RenderContext
+{
+ public:
+  /// @brief Creates a context rendering into @p window
+  /// @param shareWith Context whose textures and fonts become visible in the
+  ///        new one; must not be current on another thread
+  /// @return nullptr on failure (logged)
+  /// @note The calling thread's current context is left unchanged
+  static RenderContext* Create(SDL_Window* window,
+                               RenderContext* shareWith = nullptr);
+  /// @brief Creates a windowless context rendering into a @p width x
+  ///        @p height offscreen target (see Renderer::InitHeadless)
+  static RenderContext* CreateHeadless(int width, int height,
+                                       RenderContext* shareWith = nullptr);
+  /// @brief Releases the context's GL objects and GL context
+  /// @note Must not be current on another thread; the calling thread's
+  ///       previous context is restored afterwards
+  ~RenderContext();
+  RenderContext(const RenderContext&) = delete;
+  RenderContext& operator=(const RenderContext&) = delete;
+
+  /// @brief Binds @p context to the calling thread (nullptr unbinds)
+  /// @return false if it is current on another thread or binding failed
+  static bool MakeCurrent(RenderContext* context);
+  /// @brief Context current on the calling thread (nullptr if none)
+  static RenderContext* Current();
+
+  /// @brief Window rendered into (nullptr when headless)
+  SDL_Window* GetWindow() const;
+
+ private:
+  RenderContext();
+
+  std::unique_ptr<internal::ContextState> state_;
+};
+
 /// @brief Main graphics controller (static class)
-/// @warning Most methods must be called from render thread
+/// @warning Most methods must be called from render thread, i.e. a thread
+///          with a current RenderContext
 
 class Renderer
 {
  public:
   // 初始化/销毁
   /// @brief Initializes graphics subsystem
+  /// @note Creates the default RenderContext and makes it current
     /// @return true if successful
     /// @throws std::runtime_error on OpenGL/GLEW errors
   static bool Init(SDL_Window* window);
-  /// @brief Releases all graphics resources
+  /// @brief Initializes without a window, rendering into a @p width x
+  ///        @p height offscreen framebuffer
+  /// @note Uses an EGL surfaceless/pbuffer context when built with EGL (works
+  ///       with Mesa llvmpipe), otherwise a hidden SDL window's context.
+  ///       Present() does not swap; it queues the frame for ReadPixels.
+  static bool InitHeadless(int width, int height);
+  /// @brief Reallocates the headless target; pending readbacks are dropped
+  static bool ResizeHeadless(int width, int height);
+  /// @brief Copies the oldest presented, not yet read headless frame into
+  ///        @p pixels as top-down RGBA8 rows
+  /// @param pitch Bytes between rows of @p pixels (0 = width * 4)
+  /// @return false if no frame is pending or @p pitch is below width * 4
+  /// @note Present starts an asynchronous glReadPixels into one of two pixel
+  ///       buffers. Reading frame N after presenting N+1 lets the download
+  ///       overlap rendering; when both buffers are pending, Present drops
+  ///       the older frame.
+  /// @code
+  ///   Draw(0); Present();
+  ///   for (i = 1; i < n; ++i) { Draw(i); Present(); ReadPixels(buf); Save(i - 1); }
+  ///   ReadPixels(buf); Save(n - 1);
+  /// @endcode
+  static bool ReadPixels(void* pixels, size_t pitch = 0);
+  /// @brief Headless frames presented but not yet read (0 to 2)
+  static int PendingReadbacks();
+  /// @brief Releases all graphics resources and the default context
+  /// @note Delete the other RenderContexts first
   static void Shutdown();
 
   // 状态控制
@@ -176,13 +456,107 @@ class Renderer
   /// @brief Sets viewport dimensions
     /// @param area Viewport rectangle in screen coordinates
   static void SetViewport(Rect area);
+  /// @brief Sets blend state for subsequent draws (default: BlendMode::Alpha)
+  static void SetBlendMode(BlendMode mode);
+  static BlendMode GetBlendMode();
+  /// @brief Sets the projection applied to subsequent draws (Init sets a
+  ///        y-down ortho projection of the target size)
+  static void SetProjection(const glm::mat4& projection);
+  static const glm::mat4& GetProjection();
+
+  // 批处理
+  /// @brief Enables/disables quad batching
+  /// @note While enabled, DrawRect/DrawTexture append pre-transformed vertices
+  ///       to a CPU buffer which is submitted as one indexed draw whenever the
+  ///       texture or blend state changes, the buffer fills up, or at Present()
+  static void SetBatching(bool enabled);
+  static bool IsBatching();
+  /// @brief Submits any pending batched geometry immediately
+  static void Flush();
+  /// @brief Batcher statistics of the last presented frame
+  static BatchStats GetBatchStats();
+
+  /// @brief Dynamic geometry ring buffer counters of the last presented frame
+  static StreamStats GetStreamStats();
+
+  // 着色器缓存
+  /// @brief Directory for linked program binaries, keyed by source hash and
+  ///        GL vendor/renderer/version; empty disables the cache
+  /// @note Call before Init to cover the built-in programs. Defaults to
+  ///       SDL_GetPrefPath("libGfx", "shader-cache")
+  static void SetShaderCacheDirectory(const std::string& path);
+  static ShaderCacheStats GetShaderCacheStats();
+
+  // 脏区跟踪
+  /// @brief Enables damage tracking; the next frame is fully redrawn
+  static void SetDamageTracking(DamageMode mode);
+  static DamageMode GetDamageTracking();
+  /// @brief Marks a screen region for redraw this frame
+  /// @note Mark before drawing: draws already issued stay clipped
+  static void MarkDirty(Rect area);
+  static void MarkAllDirty();
+  /// @brief False when the whole frame may be skipped (Manual mode with
+  ///        nothing marked); idle loops should then wait for events instead
+  ///        of drawing, since Present will not block on vsync
+  static bool FrameHasDamage();
+  /// @brief Frames a back buffer lags behind (default 2 for double
+  ///        buffering); damage of that many past frames is redrawn too.
+  ///        0 means undefined contents: any damage redraws the whole screen
+  static void SetDamageBufferAge(int frames);
+  static DamageStats GetDamageStats();
+
+  // GL 状态缓存
+  /// @brief Cumulative issued/skipped GL state calls since Init or last reset
+  static GLStateStats GetGLStateStats();
+  static void ResetGLStateStats();
+  /// @brief Forgets cached GL state; call after raw GL code touched bindings
+  static void InvalidateGLState();
 
   // 绘图指令
   // Primitive drawing commands
   static void DrawRect(Rect rect, Color fill);
+  /// @note Lines are tessellated into triangles on the CPU, so any width is
+  ///       honoured (glLineWidth is clamped to 1 on core profiles)
   static void DrawLine(Point p1, Point p2, Color color, float width = 1.0f);
+  /// @brief Draws a connected thick line strip as a single batched draw
+  /// @param closed Joins the last point back to the first
+  static void DrawPolyline(const Point* points, size_t count, Color color,
+                           const StrokeStyle& style = StrokeStyle(),
+                           bool closed = false);
+  static void DrawPolyline(const std::vector<Point>& points, Color color,
+                           const StrokeStyle& style = StrokeStyle(),
+                           bool closed = false)
+  {
+    DrawPolyline(points.data(), points.size(), color, style, closed);
+  }
+  /// @brief Draws independent segments (points[0]-points[1], points[2]-...)
+  ///        as a single batched draw
+  static void DrawLines(const Point* points, size_t count, Color color,
+                        float width = 1.0f);
   static void DrawTexture(Texture* tex, Rect dest, float rotation = 0.0f);
   static void DrawTexture(GLuint tex, Rect dest, float rotation = 0.0f);
+  /// @brief Draws a TextureAtlas entry; consecutive entries of the same page
+  ///        share one texture binding (one batch when batching)
+  static void DrawTexture(const SubTexture& sub, Rect dest,
+                          float rotation = 0.0f);
+
+  // 实例化绘制：整组实例一次 glDrawArraysInstanced
+  /// @brief Draws many solid rects with a single instanced draw call
+  static void DrawRectsInstanced(const RectInstance* rects, size_t count);
+  static void DrawRectsInstanced(const std::vector<RectInstance>& rects)
+  {
+    DrawRectsInstanced(rects.data(), rects.size());
+  }
+  /// @brief Draws many quads sampling one texture with a single draw call
+  static void DrawSpritesInstanced(GLuint tex, const SpriteInstance* sprites,
+                                   size_t count);
+  static void DrawSpritesInstanced(Texture* tex, const SpriteInstance* sprites,
+                                   size_t count);
+  static void DrawSpritesInstanced(Texture* tex,
+                                   const std::vector<SpriteInstance>& sprites)
+  {
+    DrawSpritesInstanced(tex, sprites.data(), sprites.size());
+  }
 
   static void DrawText(const std::string& text, Point pos, Font* font);
   static void DrawText(const std::string& text, Point pos, FontA* font,Color color,float scale= 1.0f, float rotation = 0.0f);
@@ -199,61 +573,290 @@ class Renderer
   /**
    * 从文件加载纹理
    * @param path 图像文件路径
-   * @return 新创建的纹理对象指针，失败返回nullptr
+   * @return 纹理对象指针，失败返回nullptr；同一路径重复加载返回同一对象
+   *         并增加其引用计数（可能仍是 LoadTextureAsync 的加载中纹理）
    */
   static Texture* LoadTexture(const std::string& path);
 
   /**
    * 释放纹理资源
-   * @param tex 要释放的纹理对象
+   * @param tex 要释放的纹理对象；缓存纹理仅在最后一个引用释放时销毁
    */
   static void ReleaseTexture(Texture* tex);
+
+  // 资源包
+  /// @brief Mounts a gfxpack file; LoadTexture and LoadTextureAsync look a
+  ///        path up in mounted packs (last mounted first) before decoding
+  ///        the image file
+  /// @return false if the pack cannot be opened
+  /// @note May be called while other contexts load textures; a load that
+  ///       already found its pack finishes before the pack is unmapped
+  static bool MountAssetPack(const std::string& path);
+  /// @brief Unmounts every pack; textures already created stay valid
+  static void UnmountAssetPacks();
+
+  // 纹理缓存
+  /// @brief Keeps cached textures after their last release until
+  ///        TrimTextureCache() (default: free immediately)
+  static void SetTextureCacheRetain(bool retain);
+  /// @brief Frees cached textures with no references
+  /// @return Number of textures freed
+  static size_t TrimTextureCache();
+  static TextureCacheStats GetTextureCacheStats();
+
+  // 异步纹理加载
+  /**
+   * 在后台线程解码图像，GPU 上传推迟到渲染线程按帧预算进行
+   * @param path 图像文件路径
+   * @return 立即返回的纹理对象；上传完成前 id 指向占位纹理，
+   *         可照常绘制和 ReleaseTexture（会取消未完成的加载）
+   */
+  /// @note Shares the LoadTexture cache
+  static Texture* LoadTextureAsync(const std::string& path);
+  /// @brief True once the decoded image replaced the placeholder
+  static bool IsTextureReady(const Texture* tex);
+  /// @brief Upload budget applies immediately; workerThreads only before the
+  ///        first LoadTextureAsync call
+  static void ConfigureAsyncLoading(const AsyncLoadConfig& config);
+  /// @brief Texture shown while loading; nullptr restores the built-in one
+  /// @note Must outlive every load started while it is set
+  static void SetPlaceholderTexture(const Texture* placeholder);
+  /// @brief Uploads decoded images within the per-frame budget
+  /// @note Present calls this; call it manually to upload before drawing
+  static void ProcessTextureUploads();
+  static AsyncLoadStats GetAsyncLoadStats();
+
   // 窗口大小变化处理
   static void HandleWindowResize(int width, int height)
   {
-    s_projection = glm::ortho(0.0f, (float)width, (float)height, 0.0f);
+    Flush();
+    MarkAllDirty();
+    SetProjection(glm::ortho(0.0f, (float)width, (float)height, 0.0f));
     glViewport(0, 0, width, height);
   }
 };
 
 // ==================== Resource Management ====================
 
+/// @brief Lifecycle of a Texture returned by Renderer::LoadTextureAsync
+enum class TextureState : uint8_t
+{
+  Ready,    ///< id names the texture's own image
+  Loading,  ///< id names the placeholder; decode or upload still pending
+  Failed    ///< Loading failed; id keeps naming the placeholder
+};
+
 /// @brief GPU texture resource
-/// @note Managed via reference counting
+/// @note Textures from LoadTexture/LoadTextureAsync are shared per path and
+///       reference counted; release each reference with ReleaseTexture.
+///       Contexts of a share group other than the uploading one must reach
+///       the name through Bind or the Renderer draw calls, which wait for
+///       the upload before first use; id, width and height of an
+///       asynchronous load change on the render thread when it completes
 struct Texture
 {
-  GLuint id;
-  int width, height;
-  ~Texture()
+  GLuint id = 0;
+  int width = 0, height = 0;  ///< 0 until an asynchronous load completes
+
+  Texture() = default;
+  Texture(GLuint id, int width, int height)
+      : id(id), width(width), height(height)
+  {
+  }
+  /// @brief Copies name and size only; cache and load bookkeeping stay
+  ///        with @p other
+  Texture(const Texture& other) : Texture(other.id, other.width, other.height)
+  {
+  }
+  Texture& operator=(const Texture& other)
   {
-    if (id) glDeleteTextures(1, &id);
+    id = other.id;
+    width = other.width;
+    height = other.height;
+    return *this;
   }
+  ~Texture();
 
-  void Bind(GLuint unit = 0) const
+  void Bind(GLuint unit = 0) const;
+
+ private:
+  friend struct internal::TextureAccess;
+  internal::TextureRecord* record_ = nullptr;  // 缓存与异步加载的内部状态
+};
+
+/// @brief Image packed into a TextureAtlas page
+struct SubTexture
+{
+  GLuint texture = 0;                  ///< Atlas page texture
+  Rect uv{0.0f, 0.0f, 1.0f, 1.0f};     ///< (u0, v0, width, height) in UV space
+  int width = 0, height = 0;           ///< Image size in pixels
+};
+
+namespace internal
+{
+class ShelfPacker;
+}
+
+/// @brief Packs many small images into shared RGBA pages at load time
+/// @note Entries are padded with their own edge pixels so linear filtering
+///       does not bleed neighbours in. Images larger than a page get a
+///       dedicated page of their own size. Returned pointers stay valid for
+///       the atlas lifetime.
+class TextureAtlas
+{
+ public:
+  explicit TextureAtlas(int pageSize = 1024, int padding = 1);
+  ~TextureAtlas();
+  TextureAtlas(const TextureAtlas&) = delete;
+  TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+  /// @brief Loads an image file; adding the same path again returns the
+  ///        existing entry
+  /// @return nullptr if the image cannot be loaded
+  const SubTexture* Add(const std::string& path);
+  /// @brief Packs tightly packed RGBA8 pixels under @p name
+  const SubTexture* Add(const std::string& name, const void* rgba, int width,
+                        int height);
+  const SubTexture* Find(const std::string& name) const;
+
+  size_t GetPageCount() const { return pages_.size(); }
+  size_t GetEntryCount() const { return entries_.size(); }
+
+ private:
+  struct Page
   {
-    glActiveTexture(GL_TEXTURE0 + unit);
-    glBindTexture(GL_TEXTURE_2D, id);
+    GLuint texture = 0;
+    std::unique_ptr<internal::ShelfPacker> packer;
+  };
 
-  }
+  bool Place(int w, int h, GLuint& texture, int& x, int& y, int& pageW,
+             int& pageH);
+
+  int pageSize_;
+  int padding_;
+  std::vector<Page> pages_;
+  std::unordered_map<std::string, SubTexture> entries_;
+  std::vector<uint8_t> scratch_;  // 带边缘外扩的上传缓冲
+};
+
+/// @brief Read-only, memory-mapped pack of pre-decoded RGBA8 textures
+///        written by the gfxpack tool
+/// @note Texel data (including prebuilt mip levels) goes to glTexImage2D
+///       straight from the mapping: nothing is decoded, converted or copied
+///       on the CPU at load time
+class AssetPack
+{
+ public:
+  /// @return nullptr if the file is missing, truncated or of another version
+  static AssetPack* Open(const std::string& path);
+  ~AssetPack();
+  AssetPack(const AssetPack&) = delete;
+  AssetPack& operator=(const AssetPack&) = delete;
+
+  bool Contains(const std::string& name) const;
+  /// @brief Creates a new texture from the named entry (not cached)
+  /// @return nullptr if there is no such entry or the upload failed
+  Texture* LoadTexture(const std::string& name) const;
+
+  size_t GetEntryCount() const;
+  const std::string& GetPath() const { return path_; }
+
+ private:
+  AssetPack() = default;
+  const void* FindEntry(const std::string& name) const;
+
+  std::string path_;
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  void* file_ = nullptr;     // Windows 文件与映射句柄
+  void* mapping_ = nullptr;
 };
 
 // ==================== 字体系统 ====================
+/// @brief SDL_ttf font that renders whole strings into textures
+/// @note Rendered strings are kept in a per-font LRU cache keyed by text,
+///       color and font style, bounded by a byte budget (default 8 MiB)
 class FontA {
   public:
+      /// @brief Text texture cache counters
+      struct CacheStats
+      {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+      };
+
       static FontA* Load(const std::string& path, int size);
       static void Release(FontA* font);
+      /// @brief Returns the cached texture for (text, color, style), rendering
+      ///        it on a miss
+      /// @warning The texture is owned by the cache; it stays valid until it
+      ///          is evicted or the cache is invalidated, so do not keep it
+      ///          across frames
       static Texture* GetTextTexture(FontA* font, const char* text, Color color);
+
+      /// @brief Sets the cache byte budget, evicting LRU entries if needed
+      static void SetCacheBudget(FontA* font, size_t bytes);
+      /// @brief Drops every cached texture of this font
+      static void InvalidateCache(FontA* font);
+      static CacheStats GetCacheStats(const FontA* font);
   
       TTF_Font* GetRaw() const { return font_; }
   
   private:
+      struct TextKey
+      {
+        std::string text;
+        uint32_t color;
+        int style;  // TTF_GetFontStyle | outline << 8
+
+        bool operator==(const TextKey& other) const
+        {
+          return color == other.color && style == other.style &&
+                 text == other.text;
+        }
+      };
+      struct TextKeyHash
+      {
+        size_t operator()(const TextKey& k) const noexcept
+        {
+          size_t h = std::hash<std::string>()(k.text);
+          h ^= (static_cast<size_t>(k.color) + 0x9e3779b9 + (h << 6) + (h >> 2));
+          h ^= (static_cast<size_t>(k.style) + 0x9e3779b9 + (h << 6) + (h >> 2));
+          return h;
+        }
+      };
+      struct CacheEntry
+      {
+        TextKey key;
+        Texture* texture;
+        size_t bytes;
+      };
+      using LruList = std::list<CacheEntry>;
+
       FontA() = default;
+      void EvictToBudget(size_t budget);
+
       TTF_Font* font_ = nullptr;
-      std::string TextCache="";
-      Texture* TextureCached;
+      LruList lru_;  // 队首为最近使用
+      std::unordered_map<TextKey, LruList::iterator, TextKeyHash> entries_;
+      size_t budget_ = 8u << 20;
+      CacheStats stats_;
   };
   
+namespace internal
+{
+class GlyphAtlas;
+}
+
 /// @brief Font resource with glyph cache
+/// @note Glyph bitmaps are packed into shared atlas pages, so a whole
+///       string renders as one batched draw per page. The FreeType face stays
+///       open: glyphs outside the preloaded ASCII range are rasterized on
+///       first use, and when the page budget is exhausted the least recently
+///       used page is evicted (its glyphs are re-rasterized on demand).
 class Font
 {
  public:
@@ -270,63 +873,374 @@ class Font
     int bitmap_left;
     int bitmap_top;
     int advance_x;
-    GLuint texture;
+    GLuint texture;  ///< Atlas page texture (0 for blank glyphs such as space)
     int w;
     int h;
-    Glyph() : bitmap_left(0), bitmap_top(0), advance_x(0), texture(0),w(0),h(0) {}
+    float u0, v0, u1, v1;  ///< Atlas UVs; (u0, v0, u1-u0, v1-v0) feeds uvRect
+    Glyph() : bitmap_left(0), bitmap_top(0), advance_x(0), texture(0),w(0),h(0),
+              u0(0), v0(0), u1(1), v1(1) {}
     Glyph(int left, int top, int advance, GLuint tex,int mw,int mh)
-        : bitmap_left(left), bitmap_top(top), advance_x(advance), texture(tex),w(mw),h(mh) {}
+        : bitmap_left(left), bitmap_top(top), advance_x(advance), texture(tex),w(mw),h(mh),
+          u0(0), v0(0), u1(1), v1(1) {}
 
 };
 
+  /// @brief Glyph cache counters
+  struct CacheStats
+  {
+    uint64_t hits = 0;
+    uint64_t misses = 0;     ///< Glyphs rasterized on demand
+    uint64_t evictions = 0;  ///< Atlas pages recycled by LRU
+    size_t pages = 0;
+    size_t bytes = 0;        ///< GPU memory held by atlas pages
+  };
 
+  /// @brief Looks up a glyph, rasterizing it on a cache miss
+  /// @return nullptr only if FreeType cannot render the codepoint
+  /// @warning The pointer is invalidated by the next GetGlyph call that
+  ///          evicts a page
   const Glyph* GetGlyph(char32_t codepoint) const;
-  
+  /// @brief Number of atlas pages backing the glyphs
+  size_t GetAtlasPageCount() const;
+
+  /// @brief Caps GPU memory used by atlas pages (default 16 MiB, at least
+  ///        one page); shrinking evicts least recently used pages
+  void SetCacheBudget(size_t bytes);
+  CacheStats GetCacheStats() const;
+
+  ~Font();
+
  private:
-  std::unordered_map<char32_t, Glyph> glyphs;
+  Font();
+  bool Rasterize(char32_t codepoint, Glyph& out) const;
+  void DropPageGlyphs(GLuint texture) const;
+
+  // 字形缓存是实现细节：const 查找也会按需光栅化与淘汰
+  mutable std::unordered_map<char32_t, Glyph> glyphs;
+  std::unique_ptr<internal::GlyphAtlas> atlas_;
+  FT_Library library_ = nullptr;
+  FT_Face face_ = nullptr;
+  Color color_;
+  mutable CacheStats stats_;
+  mutable std::vector<uint8_t> scratch_;  // 光栅化时复用的 RGBA 缓冲
 
 };
 
 // ==================== 高级功能 ====================
 namespace advanced{
 // 离屏渲染
+/// @brief Offscreen render target with an RGBA8 color texture and an
+///        optional depth/stencil renderbuffer
+/// @note While bound, Renderer draws land in the color texture using the
+///       same top-left origin as the window, so GetColorTexture() can be
+///       passed to DrawTexture as-is. Contents are premultiplied by the
+///       default Alpha blend; composite them with BlendMode::Premultiplied.
 class Framebuffer
 {
  public:
-  // Framebuffer(int width, int height);
-  //~Framebuffer();
+  Framebuffer(int width, int height, bool depth = false);
+  ~Framebuffer();
+  Framebuffer(const Framebuffer&) = delete;
+  Framebuffer& operator=(const Framebuffer&) = delete;
+
+  /// @brief False if the GL framebuffer turned out incomplete
+  bool IsValid() const { return fbo != 0; }
+
+  /// @brief Redirects subsequent draws here (flushes pending batches);
+  ///        viewport and projection are set to the framebuffer size
+  void Bind();
+  /// @brief Restores the target, viewport and projection active at Bind()
+  void Unbind();
+  /// @brief Reallocates the attachments; contents become undefined
+  bool Resize(int width, int height);
 
-  // void Bind();
-  // void Unbind();
+  int GetWidth() const { return width_; }
+  int GetHeight() const { return height_; }
   Texture* GetColorTexture() const
   {
     return colorTex.get();
   }
 
  private:
-  GLuint fbo;
+  bool Allocate();
+  void Release();
+
+  GLuint fbo = 0;
   std::unique_ptr<Texture> colorTex;
-  GLuint depthBuffer;
+  GLuint depthBuffer = 0;
+  int width_ = 0, height_ = 0;
+  bool hasDepth_ = false;
+
+  // Bind() 时保存、Unbind() 时恢复
+  bool bound_ = false;
+  GLuint prevFramebuffer_ = 0;
+  GLint prevViewport_[4] = {0, 0, 0, 0};
+  glm::mat4 prevProjection_;
+};
+
+/// @brief Draws a rarely changing sub-scene once into a Framebuffer and
+///        composites it with a single textured quad afterwards
+class CachedLayer
+{
+ public:
+  CachedLayer(int width, int height, bool depth = false);
+
+  /// @brief Re-renders via @p redraw if invalidated, then draws the layer
+  /// @param redraw Draws the content in layer-local coordinates onto a
+  ///        transparent background
+  void Draw(Rect dest, const std::function<void()>& redraw);
+  /// @brief Forces the next Draw to re-render the content
+  void Invalidate() { dirty_ = true; }
+  bool IsDirty() const { return dirty_; }
+  /// @brief Resizes the backing framebuffer and invalidates the layer
+  bool Resize(int width, int height);
+
+  Framebuffer& GetFramebuffer() { return framebuffer_; }
+
+ private:
+  Framebuffer framebuffer_;
+  bool dirty_ = true;
 };
 
 // 着色器系统
+/// @brief User GLSL program with cached uniform locations
+/// @note Linked through the program binary disk cache; uniform values go
+///       through the renderer's state cache, so repeated identical
+///       SetUniform calls are free
 class Shader
 {
  public:
-  // static Shader* Create(const char* vsSrc, const char* fsSrc);
-  // void Use();
-  // void SetUniform(const char* name, float value);
-  // void SetUniform(const char* name, const Color& color);
+  /// @return New shader, or nullptr if compiling or linking failed
+  static Shader* Create(const char* vsSrc, const char* fsSrc);
+  ~Shader();
+  Shader(const Shader&) = delete;
+  Shader& operator=(const Shader&) = delete;
+
+  /// @brief Makes this program current (flushes pending batched draws)
+  void Use();
+  /// @brief Cached glGetUniformLocation; -1 if the uniform is inactive
+  GLint GetUniformLocation(const char* name);
+
+  // 设置 uniform 前自动 Use()
+  void SetUniform(const char* name, float value);
+  void SetUniform(const char* name, int value);
+  void SetUniform(const char* name, const glm::vec2& value);
+  void SetUniform(const char* name, const glm::vec4& value);
+  void SetUniform(const char* name, const glm::mat4& value);
+  void SetUniform(const char* name, const Color& color);
+
+  GLuint GetProgram() const { return program_; }
+
+ private:
+  explicit Shader(GLuint program) : program_(program) {}
+
+  GLuint program_ = 0;
+  std::unordered_map<std::string, GLint> locations_;
 };
 }  // namespace advanced
 
 // ==================== 线程安全渲染 ====================
 namespace async
 {
-// void RunOnRenderThread(std::function<void()> task);
-// void ProcessTasks(); // 每帧调用
+/// @brief Draw commands recorded on any thread and replayed on the render
+///        thread through the regular Renderer::Draw* calls
+/// @note Point/instance/text data is copied at record time; Texture, Font
+///       and FontA pointers are dereferenced at replay and must stay alive
+///       until ProcessTasks has run. Not thread-safe itself: one list per
+///       producer thread (see ThreadCommandList).
+class CommandList
+{
+ public:
+  void DrawRect(Rect rect, Color fill);
+  void DrawLine(Point p1, Point p2, Color color, float width = 1.0f);
+  void DrawPolyline(const Point* points, size_t count, Color color,
+                    const StrokeStyle& style = StrokeStyle(),
+                    bool closed = false);
+  void DrawLines(const Point* points, size_t count, Color color,
+                 float width = 1.0f);
+  void DrawTexture(Texture* tex, Rect dest, float rotation = 0.0f);
+  void DrawTexture(GLuint tex, Rect dest, float rotation = 0.0f);
+  void DrawRectsInstanced(const RectInstance* rects, size_t count);
+  void DrawSpritesInstanced(GLuint tex, const SpriteInstance* sprites,
+                            size_t count);
+  void DrawSpritesInstanced(Texture* tex, const SpriteInstance* sprites,
+                            size_t count);
+  void DrawText(const std::string& text, Point pos, Font* font);
+  void DrawText(const std::string& text, Point pos, FontA* font, Color color,
+                float scale = 1.0f, float rotation = 0.0f);
+  void SetBlendMode(BlendMode mode);
+
+  /// @brief Replays every command in recording order (render thread only)
+  void Execute() const;
+  /// @brief Drops recorded commands but keeps allocated capacity
+  void Reset();
+  size_t Size() const { return commands_.size(); }
+  bool Empty() const { return commands_.empty(); }
+
+ private:
+  enum class Op : uint8_t
+  {
+    Rect,
+    Polyline,
+    Lines,
+    Texture,
+    TextureId,
+    RectsInstanced,
+    SpritesInstanced,
+    SpritesInstancedId,
+    Text,
+    TextA,
+    Blend
+  };
+  struct Command
+  {
+    Op op;
+    Color color;
+    Rect rect{0.0f, 0.0f, 0.0f, 0.0f};
+    float rotation = 0.0f;
+    float scale = 1.0f;
+    StrokeStyle style;
+    bool closed = false;
+    BlendMode blend = BlendMode::Alpha;
+    GLuint texture = 0;
+    void* resource = nullptr;  // Texture* / Font* / FontA*
+    size_t first = 0;                // 在对应数据数组中的起点与数量
+    size_t count = 0;
+  };
+
+  Command& Push(Op op);
+
+  std::vector<Command> commands_;
+  std::vector<Point> points_;
+  std::vector<RectInstance> rects_;
+  std::vector<SpriteInstance> sprites_;
+  std::string text_;
+};
+
+/// @brief Command list owned by the calling thread
+CommandList& ThreadCommandList();
+
+/// @brief Hands @p list to the render thread for the next ProcessTasks
+/// @param order Replay key; lists replay in ascending order, equal keys in
+///        submission order (give each producer its own key for a
+///        deterministic frame)
+/// @note Thread-safe. @p list is left empty, reusing the capacity of a
+///       previously replayed list when one is available
+void Submit(CommandList& list, uint32_t order);
+/// @brief Submits and empties ThreadCommandList()
+void SubmitThreadCommandList(uint32_t order);
+
+/// @brief Queues arbitrary work (e.g. GL calls) for the render thread
+/// @note Thread-safe; tasks run in FIFO order at the next ProcessTasks
+void RunOnRenderThread(std::function<void()> task);
+/// @brief Runs queued tasks, then replays submitted command lists sorted by
+///        order key (render thread, once per frame where the recorded
+///        content should land)
+void ProcessTasks();
+}  // namespace async
+
+// ==================== 性能剖析 ====================
+// 以 -DGFX_ENABLE_PROFILER（CMake: LIBGFX_PROFILER=ON）编译时生效；
+// 未启用时宏展开为空、接口为空内联函数，没有任何运行时开销。
+namespace profiler
+{
+/// @brief Per-frame counters, reset at every Renderer::Present
+enum class Counter : uint8_t
+{
+  DrawCalls,            ///< glDraw* calls issued
+  TextureBinds,         ///< glBindTexture calls not skipped by the state cache
+  BytesUploaded,        ///< Vertex, instance and texel bytes handed to GL
+  GlyphsRasterized,     ///< Font glyphs rendered by FreeType
+  TextTexturesCreated,  ///< FontA text textures created (cache misses)
+  Count
+};
+
+/// @brief Profile of one frame (see GetLastFrame)
+struct FrameProfile
+{
+  uint64_t frame = 0;     ///< Index of the frame (number of Present calls)
+  double cpuMs = 0.0;     ///< Wall time from the previous Present to this one
+  double gpuMs = -1.0;    ///< GPU time of the top-level zones of gpuFrame;
+                          ///< -1 until timer queries have resolved
+  uint64_t gpuFrame = 0;  ///< GPU results lag a few frames behind
+  uint64_t counters[static_cast<int>(Counter::Count)] = {};
+
+  uint64_t Get(Counter counter) const
+  {
+    return counters[static_cast<int>(counter)];
+  }
+};
+
+#ifdef GFX_ENABLE_PROFILER
+namespace detail
+{
+extern std::atomic<uint64_t> g_counters[static_cast<int>(Counter::Count)];
 }
 
+/// @brief Adds @p n to a counter of the current frame (any thread)
+inline void Count(Counter counter, uint64_t n = 1)
+{
+  detail::g_counters[static_cast<int>(counter)].fetch_add(
+      n, std::memory_order_relaxed);
+}
+
+/// @brief Scoped CPU timing zone (any thread)
+/// @note Outermost zones on the render thread are also timed on the GPU with
+///       GL_TIME_ELAPSED queries (such queries cannot nest, so inner zones
+///       are CPU-only). @p name must have static storage duration.
+class Zone
+{
+ public:
+  explicit Zone(const char* name);
+  ~Zone();
+  Zone(const Zone&) = delete;
+  Zone& operator=(const Zone&) = delete;
+
+ private:
+  const char* name_;
+  uint64_t beginNs_;
+  GLuint query_ = 0;
+};
+
+/// @brief Counters and timings of the most recently presented frame
+FrameProfile GetLastFrame();
+
+/// @brief Starts recording zones and per-frame counters for trace export,
+///        discarding any previous capture
+void StartCapture();
+void StopCapture();
+bool IsCapturing();
+/// @brief Writes the captured events as Chrome trace JSON
+///        (chrome://tracing, Perfetto); GPU zones appear on their own track
+/// @return false if the file cannot be written
+bool SaveChromeTrace(const std::string& path);
+
+/// @brief Draws frame times, a frame time graph and the counters of the last
+///        frame at @p pos (top-left) with the library's own primitives
+/// @note Its own draws show up in the next frame's counters
+void DrawOverlay(Font* font, Point pos);
+
+#define GFX_PROFILE_CONCAT_(a, b) a##b
+#define GFX_PROFILE_CONCAT(a, b) GFX_PROFILE_CONCAT_(a, b)
+/// 为当前作用域计时，例：GFX_PROFILE_ZONE("Renderer::Present");
+#define GFX_PROFILE_ZONE(name) \
+  ::gfx::profiler::Zone GFX_PROFILE_CONCAT(gfxProfileZone_, __LINE__)(name)
+/// 累加计数器，例：GFX_PROFILE_COUNT(DrawCalls, 1);
+#define GFX_PROFILE_COUNT(counter, n) \
+  ::gfx::profiler::Count(::gfx::profiler::Counter::counter, (n))
+#else
+inline FrameProfile GetLastFrame() { return FrameProfile{}; }
+inline void StartCapture() {}
+inline void StopCapture() {}
+inline bool IsCapturing() { return false; }
+inline bool SaveChromeTrace(const std::string&) { return false; }
+inline void DrawOverlay(Font*, Point) {}
+
+#define GFX_PROFILE_ZONE(name) ((void)0)
+#define GFX_PROFILE_COUNT(counter, n) ((void)0)
+#endif
+}  // namespace profiler
+
 // ==================== Preset Colors ====================
 const Color Black(0x000000FF);
 const Color White(0xFFFFFFFF);
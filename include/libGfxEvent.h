@@ -1,6 +1,10 @@
 #ifndef NEBULAXLIBGFXEVENT_H
 #define NEBULAXLIBGFXEVENT_H
 #include "libGfx.h"
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
 namespace gfx{
 namespace Event
 {
@@ -14,7 +18,9 @@ namespace Event
         MouseWheel,
         KeyDown,
         KeyUp,
-        TextInput
+        TextInput,
+        MouseEnter,     // Region listeners only
+        MouseLeave      // Region listeners only
     };
 
     // ==================== Mouse Button Definitions ====================
@@ -96,6 +102,8 @@ namespace Event
     struct Event
     {
         EventType type = EventType::None;
+        uint32_t timestamp = 0;     // SDL event timestamp (ms since SDL_Init)
+        uint64_t timeNs = 0;        // Steady clock time of translation (ns)
         
         // Mouse events data
         struct
@@ -127,13 +135,250 @@ namespace Event
     };
 
     // ==================== Event Listener Interface ====================
-    using EventCallback = std::function<void(const Event&)>;
+    // Move-only callable taking `const Event&`. Callables up to kInlineSize
+    // bytes (e.g. lambdas capturing a few pointers) are stored inline
+    // without allocating; larger ones are moved to the heap.
+    class EventCallback
+    {
+    public:
+        static constexpr size_t kInlineSize = 6 * sizeof(void*);
+
+        EventCallback() = default;
+        template <typename F, typename Fn = std::decay_t<F>,
+                  typename = std::enable_if_t<
+                      !std::is_same<Fn, EventCallback>::value &&
+                      std::is_invocable<Fn&, const Event&>::value>>
+        EventCallback(F&& fn)
+        {
+            if constexpr (IsInline<Fn>())
+                ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(fn));
+            else
+                *reinterpret_cast<Fn**>(storage_) = new Fn(std::forward<F>(fn));
+            ops_ = &kOps<Fn>;
+        }
+        EventCallback(EventCallback&& other) noexcept { MoveFrom(other); }
+        EventCallback& operator=(EventCallback&& other) noexcept
+        {
+            if (this != &other) {
+                Reset();
+                MoveFrom(other);
+            }
+            return *this;
+        }
+        EventCallback(const EventCallback&) = delete;
+        EventCallback& operator=(const EventCallback&) = delete;
+        ~EventCallback() { Reset(); }
+
+        void operator()(const Event& event) { ops_->invoke(storage_, event); }
+        explicit operator bool() const { return ops_ != nullptr; }
+        void Reset()
+        {
+            if (ops_) ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+
+    private:
+        struct Ops
+        {
+            void (*invoke)(void* storage, const Event& event);
+            void (*move)(void* dst, void* src) noexcept;  // Leaves src destroyed
+            void (*destroy)(void* storage) noexcept;
+        };
+
+        template <typename Fn>
+        static constexpr bool IsInline()
+        {
+            return sizeof(Fn) <= kInlineSize &&
+                   alignof(Fn) <= alignof(std::max_align_t) &&
+                   std::is_nothrow_move_constructible<Fn>::value;
+        }
+
+        template <typename Fn>
+        static Fn* Target(void* storage)
+        {
+            if constexpr (IsInline<Fn>())
+                return std::launder(reinterpret_cast<Fn*>(storage));
+            else
+                return *reinterpret_cast<Fn**>(storage);
+        }
+
+        template <typename Fn>
+        static void Invoke(void* storage, const Event& event)
+        {
+            (*Target<Fn>(storage))(event);
+        }
+
+        template <typename Fn>
+        static void Move(void* dst, void* src) noexcept
+        {
+            if constexpr (IsInline<Fn>()) {
+                ::new (dst) Fn(std::move(*Target<Fn>(src)));
+                Target<Fn>(src)->~Fn();
+            } else {
+                *reinterpret_cast<Fn**>(dst) = Target<Fn>(src);
+            }
+        }
+
+        template <typename Fn>
+        static void Destroy(void* storage) noexcept
+        {
+            if constexpr (IsInline<Fn>())
+                Target<Fn>(storage)->~Fn();
+            else
+                delete Target<Fn>(storage);
+        }
+
+        template <typename Fn>
+        static constexpr Ops kOps = {&Invoke<Fn>, &Move<Fn>, &Destroy<Fn>};
+
+        void MoveFrom(EventCallback& other) noexcept
+        {
+            if (!other.ops_) return;
+            other.ops_->move(storage_, other.storage_);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+
+        alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+        const Ops* ops_ = nullptr;
+    };
+
+    // Subscription returned by AddListener. Handles of removed listeners
+    // stay invalid even after their slot is reused
+    struct ListenerHandle
+    {
+        uint32_t index = 0;
+        uint32_t generation = 0;    // 0 = no listener
+
+        explicit operator bool() const { return generation != 0; }
+    };
 
     // ==================== Event System API ====================
     void PollEvents(SDL_Event &sdlEvent);
-    void AddListener(EventType type, EventCallback callback);
-    
-    //void RemoveListener(EventType type, EventCallback callback);
+    // Listeners run in registration order. One added from inside a callback
+    // first sees the next event
+    ListenerHandle AddListener(EventType type, EventCallback callback);
+    // O(1), and safe inside a callback (including the running listener's
+    // own). Returns false if the handle was already removed
+    bool RemoveListener(ListenerHandle handle);
+
+    // Motion coalescing (off by default): consecutive MouseMotion events are
+    // merged into one, keeping the latest position and summing `relative`.
+    // The merged event is dispatched before the next non-motion event or by
+    // DispatchPending(); call it once per frame after the SDL poll loop.
+    // Input state queries stay current while motion is held back.
+    void SetMotionCoalescing(bool enabled);
+    bool IsMotionCoalescing();
+    void DispatchPending();
+
+    // ==================== Event Queue ====================
+    // Queue mode: PollEvents stops invoking listeners and pushes the
+    // translated events into a bounded lock-free ring instead. The thread
+    // calling PollEvents is the only producer; one other thread consumes
+    // with DrainEvents or DispatchQueuedEvents. Neither side locks or
+    // allocates. Events arriving while the ring is full are dropped and
+    // counted.
+    struct EventQueueStats
+    {
+        uint64_t queued = 0;        // Events pushed since EnableEventQueue
+        uint64_t dropped = 0;       // Events lost to a full ring
+        uint32_t capacity = 0;
+        uint32_t highWater = 0;     // Highest fill level seen
+    };
+
+    // capacity is rounded up to a power of two. Call before the consumer
+    // starts; enabling again resizes and discards queued events
+    void EnableEventQueue(size_t capacity = 1024);
+    // Back to immediate dispatch; events still queued are discarded.
+    // Stop the consumer first
+    void DisableEventQueue();
+    bool IsEventQueueEnabled();
+    // Copies up to maxEvents queued events, oldest first (consumer thread)
+    size_t DrainEvents(Event* out, size_t maxEvents);
+    // Drains the ring and invokes the listeners on the calling thread
+    size_t DispatchQueuedEvents();
+    EventQueueStats GetEventQueueStats();
+
+    // ==================== Region Listeners ====================
+    // Mouse listeners scoped to a rectangle in window coordinates. Regions
+    // are indexed in a uniform grid, so a mouse event only tests the
+    // regions sharing the cursor's cell instead of every listener.
+    // MouseButtonDown/Up and MouseMotion go to the topmost region of that
+    // type under the cursor: highest z, then the most recently added.
+    // MouseEnter/MouseLeave fire on motion for every region of that type
+    // the cursor moves into or out of, topmost first.
+    // Region listeners run after the global ones on the dispatching
+    // thread; add, move and remove them from that thread (callbacks
+    // included).
+    struct RegionHandle
+    {
+        uint32_t index = 0;
+        uint32_t generation = 0;    // 0 = no region
+
+        explicit operator bool() const { return generation != 0; }
+    };
+
+    // Returns an invalid handle for non-mouse event types
+    RegionHandle AddRegionListener(const Rect& rect, EventType type,
+                                   EventCallback callback, int z = 0);
+    bool RemoveRegionListener(RegionHandle handle);
+    // Re-indexes only the grid cells the region enters or leaves.
+    // Enter/leave state catches up on the next mouse motion
+    bool SetRegionRect(RegionHandle handle, const Rect& rect);
+    bool SetRegionZ(RegionHandle handle, int z);
+    // Grid cell size in pixels (default 64); rebuilds the index. Roughly
+    // the size of a typical widget works best
+    void SetRegionCellSize(float size);
+
+    // ==================== Input Recording ====================
+    // Recording writes each SDL event handed to PollEvents that it
+    // translates (mouse buttons, motion, keys), with its timestamp, to a
+    // compact binary log of a few bytes per event
+    bool StartRecording(const std::string& path);
+    // Flushes and closes the log; returns the number of events recorded
+    size_t StopRecording();
+    bool IsRecording();
+
+    // Feeds a recording back through PollEvents, so translation, input
+    // state, coalescing, queue mode and listeners see the session as it
+    // happened. No window or input device is needed.
+    // Step() advances a virtual clock for repeatable frame-by-frame runs
+    // (e.g. Step(16) per frame); Update() follows the wall clock to replay
+    // in real time; DispatchAll() replays as fast as possible.
+    class InputReplay
+    {
+    public:
+        // nullptr if the file is missing, truncated or not a recording
+        static InputReplay* Open(const std::string& path);
+
+        // Dispatches the events due within the next `ms` of session time
+        size_t Step(uint32_t ms);
+        // Dispatches the events due by the wall time since the first call
+        size_t Update();
+        size_t DispatchAll();
+        void Rewind();
+
+        bool IsFinished() const { return !hasNext_; }
+        uint32_t GetTime() const { return time_; }          // Session ms
+        uint32_t GetDuration() const { return duration_; }  // Session ms
+        size_t GetEventCount() const { return eventCount_; }
+
+    private:
+        InputReplay() = default;
+        bool ReadNext();
+        size_t DispatchUntil(uint32_t time);
+
+        std::vector<uint8_t> data_;
+        size_t cursor_ = 0;
+        size_t eventCount_ = 0;
+        uint32_t startTicks_ = 0;
+        uint32_t duration_ = 0;
+        uint32_t time_ = 0;
+        uint32_t nextTime_ = 0;         // Session time of next_
+        SDL_Event next_{};
+        bool hasNext_ = false;
+        uint64_t wallStartNs_ = 0;      // Set by the first Update()
+    };
     
     // Helper functions
     bool IsKeyPressed(KeyCode key);
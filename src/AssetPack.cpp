@@ -0,0 +1,262 @@
+#include "AssetPackFormat.h"
+#include "libGfxInternal.h"
+
+#include <cstring>
+#include <mutex>
+#include <string_view>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gfx
+{
+namespace
+{
+// 已挂载的资源包，后挂载的优先
+// 任一上下文的 LoadTexture 都会查找；加载期间由 shared_ptr 保持映射有效
+std::mutex s_mountMutex;
+std::vector<std::shared_ptr<AssetPack>> s_mounted;
+
+const pack::Header& HeaderOf(const uint8_t* data)
+{
+  return *reinterpret_cast<const pack::Header*>(data);
+}
+
+const pack::Entry* EntriesOf(const uint8_t* data)
+{
+  return reinterpret_cast<const pack::Entry*>(data +
+                                              HeaderOf(data).indexOffset);
+}
+
+std::string_view NameOf(const uint8_t* data, const pack::Entry& entry)
+{
+  const char* names =
+      reinterpret_cast<const char*>(data + HeaderOf(data).namesOffset);
+  return std::string_view(names + entry.nameOffset, entry.nameLength);
+}
+
+// 映射后整体校验一次，之后的查找不再做边界检查
+bool Validate(const uint8_t* data, size_t size)
+{
+  if (size < sizeof(pack::Header)) return false;
+  const pack::Header& h = HeaderOf(data);
+  if (std::memcmp(h.magic, pack::kMagic, sizeof pack::kMagic) != 0 ||
+      h.version != pack::kVersion)
+    return false;
+  if (h.indexOffset % alignof(pack::Entry) != 0 ||
+      !pack::InBounds(h.indexOffset,
+                      uint64_t(h.entryCount) * sizeof(pack::Entry), size) ||
+      !pack::InBounds(h.namesOffset, h.namesSize, size))
+    return false;
+
+  const pack::Entry* entries = EntriesOf(data);
+  for (uint32_t i = 0; i < h.entryCount; ++i)
+  {
+    const pack::Entry& e = entries[i];
+    if (!pack::InBounds(e.nameOffset, e.nameLength, h.namesSize) ||
+        e.format != static_cast<uint32_t>(pack::TexelFormat::RGBA8) ||
+        !pack::InBounds(e.dataOffset, e.dataSize, size))
+      return false;
+    // 尺寸受限后各级字节数之和不会溢出，mip 循环也有界
+    if (e.width == 0 || e.height == 0 || e.width > pack::kMaxDimension ||
+        e.height > pack::kMaxDimension || e.mipLevels == 0 ||
+        e.mipLevels > pack::MaxMipLevels(e.width, e.height))
+      return false;
+    uint64_t bytes = 0;
+    for (uint32_t level = 0; level < e.mipLevels; ++level)
+      bytes += pack::LevelBytes(e.width, e.height, level);
+    if (bytes != e.dataSize) return false;
+    // FindEntry 二分查找依赖名称严格递增
+    if (i > 0 && !(NameOf(data, entries[i - 1]) < NameOf(data, e)))
+      return false;
+  }
+  return true;
+}
+}  // namespace
+
+// ================ AssetPack ================
+AssetPack* AssetPack::Open(const std::string& path)
+{
+  std::unique_ptr<AssetPack> pack(new AssetPack());
+  pack->path_ = path;
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    std::cerr << "Failed to open asset pack: " << path << std::endl;
+    return nullptr;
+  }
+  pack->file_ = file;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return nullptr;
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) return nullptr;
+  pack->mapping_ = mapping;
+  pack->data_ = static_cast<const uint8_t*>(
+      MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  pack->size_ = static_cast<size_t>(size.QuadPart);
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    std::cerr << "Failed to open asset pack: " << path << std::endl;
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    close(fd);
+    return nullptr;
+  }
+  void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                    MAP_PRIVATE, fd, 0);
+  close(fd);  // 映射保持有效
+  if (data == MAP_FAILED) return nullptr;
+  pack->data_ = static_cast<const uint8_t*>(data);
+  pack->size_ = static_cast<size_t>(st.st_size);
+#endif
+
+  if (!pack->data_ || !Validate(pack->data_, pack->size_))
+  {
+    std::cerr << "Invalid asset pack: " << path << std::endl;
+    return nullptr;
+  }
+  return pack.release();
+}
+
+AssetPack::~AssetPack()
+{
+#ifdef _WIN32
+  if (data_) UnmapViewOfFile(data_);
+  if (mapping_) CloseHandle(mapping_);
+  if (file_) CloseHandle(file_);
+#else
+  if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+}
+
+const void* AssetPack::FindEntry(const std::string& name) const
+{
+  const pack::Entry* begin = EntriesOf(data_);
+  const pack::Entry* end = begin + HeaderOf(data_).entryCount;
+  const std::string_view key(name);
+  const pack::Entry* it = std::lower_bound(
+      begin, end, key, [this](const pack::Entry& e, std::string_view k) {
+        return NameOf(data_, e) < k;
+      });
+  return it != end && NameOf(data_, *it) == key ? it : nullptr;
+}
+
+bool AssetPack::Contains(const std::string& name) const
+{
+  return FindEntry(name) != nullptr;
+}
+
+size_t AssetPack::GetEntryCount() const
+{
+  return HeaderOf(data_).entryCount;
+}
+
+Texture* AssetPack::LoadTexture(const std::string& name) const
+{
+  VerifyRenderThread();
+  const pack::Entry* entry = static_cast<const pack::Entry*>(FindEntry(name));
+  if (!entry) return nullptr;
+
+  GLint maxSize = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+  if (entry->width > static_cast<GLuint>(maxSize) ||
+      entry->height > static_cast<GLuint>(maxSize))
+  {
+    std::cerr << "Texture exceeds GL_MAX_TEXTURE_SIZE: " << name << std::endl;
+    return nullptr;
+  }
+
+  GLuint textureID;
+  glGenTextures(1, &textureID);
+  internal::GLState().BindTexture(0, textureID);
+
+  const bool mipmapped = entry->mipLevels > 1;
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                  mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                  static_cast<GLint>(entry->mipLevels - 1));
+
+  // 直接从映射上传，缺页由内核按需读入
+  const uint8_t* texels = data_ + entry->dataOffset;
+  for (uint32_t level = 0; level < entry->mipLevels; ++level)
+  {
+    glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA8,
+                 pack::LevelWidth(entry->width, level),
+                 pack::LevelWidth(entry->height, level), 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, texels);
+    texels += pack::LevelBytes(entry->width, entry->height, level);
+  }
+  GFX_PROFILE_COUNT(BytesUploaded, entry->dataSize);
+
+  GLenum err = glGetError();
+  if (err != GL_NO_ERROR)
+  {
+    std::cerr << "Failed to upload texture: " << err << std::endl;
+    internal::DeleteTexture(textureID);
+    return nullptr;
+  }
+  Texture* tex = new Texture{textureID, static_cast<int>(entry->width),
+                             static_cast<int>(entry->height)};
+  internal::FenceTextureUpload(tex, textureID);
+  return tex;
+}
+
+// ================ 挂载 ================
+namespace internal
+{
+Texture* LoadFromMountedPacks(const std::string& name)
+{
+  std::shared_ptr<AssetPack> pack;
+  {
+    std::lock_guard<std::mutex> lock(s_mountMutex);
+    for (auto it = s_mounted.rbegin(); it != s_mounted.rend(); ++it)
+    {
+      if (!(*it)->Contains(name)) continue;
+      pack = *it;
+      break;
+    }
+  }
+  // 上传不持锁，卸载只会等待查找
+  return pack ? pack->LoadTexture(name) : nullptr;
+}
+}  // namespace internal
+
+bool Renderer::MountAssetPack(const std::string& path)
+{
+  AssetPack* pack = AssetPack::Open(path);
+  if (!pack) return false;
+  std::lock_guard<std::mutex> lock(s_mountMutex);
+  s_mounted.emplace_back(pack);
+  return true;
+}
+
+void Renderer::UnmountAssetPacks()
+{
+  std::vector<std::shared_ptr<AssetPack>> unmounted;  // 在锁外解除映射
+  {
+    std::lock_guard<std::mutex> lock(s_mountMutex);
+    unmounted.swap(s_mounted);
+  }
+}
+
+}  // namespace gfx
@@ -0,0 +1,89 @@
+// gfxpack 文件格式：tools/gfxpack 写入，AssetPack 映射读取
+//
+//   Header | Entry[entryCount]（按名称排序）| 名称表 | 纹素数据（每项按
+//   kDataAlignment 对齐，mip 级别从 0 开始依次紧密排列）
+//
+// 所有整数均为小端序。
+
+#ifndef NEBULAXLIBGFX_ASSETPACKFORMAT_H
+#define NEBULAXLIBGFX_ASSETPACKFORMAT_H
+
+#include <algorithm>
+#include <cstdint>
+
+namespace gfx
+{
+namespace pack
+{
+
+constexpr char kMagic[8] = {'G', 'F', 'X', 'P', 'A', 'C', 'K', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kDataAlignment = 64;
+// 单边尺寸上限；读取端另按 GL_MAX_TEXTURE_SIZE 检查
+constexpr uint32_t kMaxDimension = 1u << 16;
+
+enum class TexelFormat : uint32_t
+{
+  RGBA8 = 0
+};
+
+struct Header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t entryCount;
+  uint64_t indexOffset;
+  uint64_t namesOffset;
+  uint64_t namesSize;
+};
+
+struct Entry
+{
+  uint64_t nameOffset;  // 相对名称表起点
+  uint32_t nameLength;
+  uint32_t format;      // TexelFormat
+  uint32_t width;
+  uint32_t height;
+  uint32_t mipLevels;   // >= 1
+  uint32_t reserved;
+  uint64_t dataOffset;  // 相对文件起点
+  uint64_t dataSize;    // 所有 mip 级别之和
+};
+
+static_assert(sizeof(Header) == 40 && sizeof(Entry) == 48,
+              "pack structs are written verbatim");
+
+inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// [offset, offset + length) 位于 [0, size) 内；写成减法形式以免加法回绕
+inline bool InBounds(uint64_t offset, uint64_t length, uint64_t size)
+{
+  return offset <= size && length <= size - offset;
+}
+
+// 完整 mip 链的级别数：floor(log2(max(w, h))) + 1
+inline uint32_t MaxMipLevels(uint32_t width, uint32_t height)
+{
+  uint32_t levels = 1;
+  for (uint32_t extent = std::max(width, height); extent > 1; extent >>= 1)
+    ++levels;
+  return levels;
+}
+
+inline uint32_t LevelWidth(uint32_t width, uint32_t level)
+{
+  return std::max<uint32_t>(1, width >> level);
+}
+
+inline uint64_t LevelBytes(uint32_t width, uint32_t height, uint32_t level)
+{
+  return uint64_t(LevelWidth(width, level)) * LevelWidth(height, level) * 4;
+}
+
+}  // namespace pack
+}  // namespace gfx
+
+#endif  // NEBULAXLIBGFX_ASSETPACKFORMAT_H
@@ -0,0 +1,286 @@
+#include "libGfxInternal.h"
+
+#include <algorithm>
+
+namespace gfx
+{
+namespace async
+{
+namespace
+{
+struct SubmittedList
+{
+  uint32_t order;
+  CommandList list;
+};
+
+// 回收的列表保留容量，Submit 时换给生产线程，避免每帧重新增长
+constexpr size_t kMaxRecycledLists = 16;
+
+std::mutex s_mutex;
+std::vector<std::function<void()>> s_tasks;
+std::vector<SubmittedList> s_submitted;
+std::vector<CommandList> s_recycled;
+}  // namespace
+
+// ================ CommandList 录制 ================
+CommandList::Command& CommandList::Push(Op op)
+{
+  commands_.emplace_back();
+  Command& cmd = commands_.back();
+  cmd.op = op;
+  return cmd;
+}
+
+void CommandList::DrawRect(Rect rect, Color fill)
+{
+  Command& cmd = Push(Op::Rect);
+  cmd.rect = rect;
+  cmd.color = fill;
+}
+
+void CommandList::DrawLine(Point p1, Point p2, Color color, float width)
+{
+  const Point points[2] = {p1, p2};
+  DrawLines(points, 2, color, width);
+}
+
+void CommandList::DrawPolyline(const Point* points, size_t count, Color color,
+                               const StrokeStyle& style, bool closed)
+{
+  Command& cmd = Push(Op::Polyline);
+  cmd.color = color;
+  cmd.style = style;
+  cmd.closed = closed;
+  cmd.first = points_.size();
+  cmd.count = count;
+  points_.insert(points_.end(), points, points + count);
+}
+
+void CommandList::DrawLines(const Point* points, size_t count, Color color,
+                            float width)
+{
+  Command& cmd = Push(Op::Lines);
+  cmd.color = color;
+  cmd.style.width = width;
+  cmd.first = points_.size();
+  cmd.count = count;
+  points_.insert(points_.end(), points, points + count);
+}
+
+void CommandList::DrawTexture(Texture* tex, Rect dest, float rotation)
+{
+  // 保存指针而非 id：异步加载的纹理在回放前可能已完成上传
+  Command& cmd = Push(Op::Texture);
+  cmd.resource = tex;
+  cmd.rect = dest;
+  cmd.rotation = rotation;
+}
+
+void CommandList::DrawTexture(GLuint tex, Rect dest, float rotation)
+{
+  Command& cmd = Push(Op::TextureId);
+  cmd.texture = tex;
+  cmd.rect = dest;
+  cmd.rotation = rotation;
+}
+
+void CommandList::DrawRectsInstanced(const RectInstance* rects, size_t count)
+{
+  Command& cmd = Push(Op::RectsInstanced);
+  cmd.first = rects_.size();
+  cmd.count = count;
+  rects_.insert(rects_.end(), rects, rects + count);
+}
+
+void CommandList::DrawSpritesInstanced(GLuint tex,
+                                       const SpriteInstance* sprites,
+                                       size_t count)
+{
+  Command& cmd = Push(Op::SpritesInstancedId);
+  cmd.texture = tex;
+  cmd.first = sprites_.size();
+  cmd.count = count;
+  sprites_.insert(sprites_.end(), sprites, sprites + count);
+}
+
+void CommandList::DrawSpritesInstanced(Texture* tex,
+                                       const SpriteInstance* sprites,
+                                       size_t count)
+{
+  Command& cmd = Push(Op::SpritesInstanced);
+  cmd.resource = tex;
+  cmd.first = sprites_.size();
+  cmd.count = count;
+  sprites_.insert(sprites_.end(), sprites, sprites + count);
+}
+
+void CommandList::DrawText(const std::string& text, Point pos, Font* font)
+{
+  Command& cmd = Push(Op::Text);
+  cmd.resource = font;
+  cmd.rect = Rect(pos.x, pos.y, 0.0f, 0.0f);
+  cmd.first = text_.size();
+  cmd.count = text.size();
+  text_ += text;
+}
+
+void CommandList::DrawText(const std::string& text, Point pos, FontA* font,
+                           Color color, float scale, float rotation)
+{
+  Command& cmd = Push(Op::TextA);
+  cmd.resource = font;
+  cmd.rect = Rect(pos.x, pos.y, 0.0f, 0.0f);
+  cmd.color = color;
+  cmd.scale = scale;
+  cmd.rotation = rotation;
+  cmd.first = text_.size();
+  cmd.count = text.size();
+  text_ += text;
+}
+
+void CommandList::SetBlendMode(BlendMode mode)
+{
+  Push(Op::Blend).blend = mode;
+}
+
+// ================ CommandList 回放 ================
+void CommandList::Execute() const
+{
+  VerifyRenderThread();
+  for (const Command& cmd : commands_)
+  {
+    const Point pos(cmd.rect.x, cmd.rect.y);
+    switch (cmd.op)
+    {
+      case Op::Rect:
+        Renderer::DrawRect(cmd.rect, cmd.color);
+        break;
+      case Op::Polyline:
+        Renderer::DrawPolyline(points_.data() + cmd.first, cmd.count,
+                               cmd.color, cmd.style, cmd.closed);
+        break;
+      case Op::Lines:
+        Renderer::DrawLines(points_.data() + cmd.first, cmd.count, cmd.color,
+                            cmd.style.width);
+        break;
+      case Op::Texture:
+        Renderer::DrawTexture(static_cast<Texture*>(cmd.resource), cmd.rect,
+                              cmd.rotation);
+        break;
+      case Op::TextureId:
+        Renderer::DrawTexture(cmd.texture, cmd.rect, cmd.rotation);
+        break;
+      case Op::RectsInstanced:
+        Renderer::DrawRectsInstanced(rects_.data() + cmd.first, cmd.count);
+        break;
+      case Op::SpritesInstanced:
+        Renderer::DrawSpritesInstanced(static_cast<Texture*>(cmd.resource),
+                                       sprites_.data() + cmd.first, cmd.count);
+        break;
+      case Op::SpritesInstancedId:
+        Renderer::DrawSpritesInstanced(cmd.texture,
+                                       sprites_.data() + cmd.first, cmd.count);
+        break;
+      case Op::Text:
+        Renderer::DrawText(text_.substr(cmd.first, cmd.count), pos,
+                           static_cast<Font*>(cmd.resource));
+        break;
+      case Op::TextA:
+        Renderer::DrawText(text_.substr(cmd.first, cmd.count), pos,
+                           static_cast<FontA*>(cmd.resource), cmd.color,
+                           cmd.scale, cmd.rotation);
+        break;
+      case Op::Blend:
+        Renderer::SetBlendMode(cmd.blend);
+        break;
+    }
+  }
+}
+
+void CommandList::Reset()
+{
+  commands_.clear();
+  points_.clear();
+  rects_.clear();
+  sprites_.clear();
+  text_.clear();
+}
+
+// ================ 提交与任务队列 ================
+CommandList& ThreadCommandList()
+{
+  thread_local CommandList list;
+  return list;
+}
+
+void Submit(CommandList& list, uint32_t order)
+{
+  if (list.Empty()) return;
+
+  std::lock_guard<std::mutex> lock(s_mutex);
+  s_submitted.push_back(SubmittedList{order, std::move(list)});
+  if (!s_recycled.empty())
+  {
+    list = std::move(s_recycled.back());
+    s_recycled.pop_back();
+  }
+  else
+  {
+    list = CommandList();
+  }
+}
+
+void SubmitThreadCommandList(uint32_t order)
+{
+  Submit(ThreadCommandList(), order);
+}
+
+void RunOnRenderThread(std::function<void()> task)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  s_tasks.push_back(std::move(task));
+}
+
+void ProcessTasks()
+{
+  VerifyRenderThread();
+
+  std::vector<std::function<void()>> tasks;
+  std::vector<SubmittedList> lists;
+  {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    tasks.swap(s_tasks);
+    lists.swap(s_submitted);
+  }
+
+  // 先执行任务（可能创建回放要用的资源），再按顺序键回放
+  for (std::function<void()>& task : tasks) task();
+
+  std::stable_sort(lists.begin(), lists.end(),
+                   [](const SubmittedList& a, const SubmittedList& b) {
+                     return a.order < b.order;
+                   });
+  for (const SubmittedList& submitted : lists) submitted.list.Execute();
+
+  std::lock_guard<std::mutex> lock(s_mutex);
+  for (SubmittedList& submitted : lists)
+  {
+    if (s_recycled.size() >= kMaxRecycledLists) break;
+    submitted.list.Reset();
+    s_recycled.push_back(std::move(submitted.list));
+  }
+}
+}  // namespace async
+
+namespace internal
+{
+void DiscardAsyncWork()
+{
+  std::lock_guard<std::mutex> lock(async::s_mutex);
+  async::s_tasks.clear();
+  async::s_submitted.clear();
+  async::s_recycled.clear();
+}
+}  // namespace internal
+}  // namespace gfx
@@ -0,0 +1,357 @@
+#include "libGfxInternal.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+
+namespace gfx
+{
+namespace
+{
+// 以边界表示的并集，便于累加与裁剪
+struct Box
+{
+  float x0 = FLT_MAX, y0 = FLT_MAX, x1 = -FLT_MAX, y1 = -FLT_MAX;
+
+  bool Empty() const { return x0 >= x1 || y0 >= y1; }
+  void Add(const Box& b)
+  {
+    if (b.Empty()) return;
+    x0 = std::min(x0, b.x0);
+    y0 = std::min(y0, b.y0);
+    x1 = std::max(x1, b.x1);
+    y1 = std::max(y1, b.y1);
+  }
+  bool Intersects(const Box& b) const
+  {
+    return x0 < b.x1 && b.x0 < x1 && y0 < b.y1 && b.y0 < y1;
+  }
+  static Box From(const Rect& r) { return {r.x, r.y, r.x + r.w, r.y + r.h}; }
+  static Box Everything() { return {-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX}; }
+};
+
+struct DrawRecord
+{
+  Box bounds;
+  uint64_t signature;
+};
+
+constexpr int kMaxBufferAge = 4;
+}  // namespace
+
+namespace internal
+{
+struct DamageState
+{
+  DamageMode mode = DamageMode::Off;
+  int bufferAge = 2;
+  int offscreenDepth = 0;
+
+  // Manual：本帧标记的区域与最近几次已呈现帧的区域（后缓冲仍缺这些更新）
+  Box frame;
+  uint32_t frameRects = 0;
+  std::array<Box, kMaxBufferAge> history;
+  bool regionDirty = true;  // region 需要重新计算
+  Box region;               // frame ∪ history，已裁剪到屏幕
+
+  // 当前下发的裁剪状态
+  bool scissorEnabled = false;
+  GLint scissor[4] = {0, 0, 0, 0};
+
+  // Auto：逐次绘制的边界与签名
+  std::vector<DrawRecord> previous;
+  std::vector<DrawRecord> current;
+
+  DamageStats frameStats;
+  DamageStats lastStats;
+};
+
+void DamageStateDeleter::operator()(DamageState* state) const
+{
+  delete state;
+}
+}  // namespace internal
+
+namespace
+{
+// 当前上下文的脏区状态，首次使用时创建
+internal::DamageState& State()
+{
+  auto& damage = internal::Ctx().damage;
+  if (!damage) damage.reset(new internal::DamageState());
+  return *damage;
+}
+
+Box ScreenBox()
+{
+  int w = 0, h = 0;
+  internal::TargetSize(&w, &h);
+  return {0.0f, 0.0f, static_cast<float>(w), static_cast<float>(h)};
+}
+
+Box Clip(Box b, const Box& to)
+{
+  b.x0 = std::max(b.x0, to.x0);
+  b.y0 = std::max(b.y0, to.y0);
+  b.x1 = std::min(b.x1, to.x1);
+  b.y1 = std::min(b.y1, to.y1);
+  return b;
+}
+
+const Box& DamageRegion()
+{
+  internal::DamageState& damage = State();
+  if (damage.regionDirty)
+  {
+    Box region = damage.frame;
+    if (!region.Empty())
+    {
+      // 后缓冲内容落后 bufferAge 帧；0 表示内容未定义，只能整屏重绘
+      if (damage.bufferAge == 0) region = Box::Everything();
+      for (int i = 0; i + 1 < damage.bufferAge; ++i)
+        region.Add(damage.history[i]);
+    }
+    damage.region = Clip(region, ScreenBox());
+    damage.regionDirty = false;
+  }
+  return damage.region;
+}
+
+void SetScissorEnabled(bool enabled)
+{
+  internal::DamageState& damage = State();
+  if (damage.scissorEnabled == enabled) return;
+  if (enabled)
+    glEnable(GL_SCISSOR_TEST);
+  else
+    glDisable(GL_SCISSOR_TEST);
+  damage.scissorEnabled = enabled;
+}
+
+void FillStats(DamageStats& stats, const Box& bounds, uint32_t rects)
+{
+  const Box screen = ScreenBox();
+  const Box clipped = Clip(bounds, screen);
+  stats.rects = rects;
+  stats.screenArea = (screen.x1 - screen.x0) * (screen.y1 - screen.y0);
+  if (clipped.Empty())
+  {
+    stats.bounds = Rect(0.0f, 0.0f, 0.0f, 0.0f);
+    stats.damagedArea = 0.0f;
+    return;
+  }
+  stats.bounds = Rect(clipped.x0, clipped.y0, clipped.x1 - clipped.x0,
+                      clipped.y1 - clipped.y0);
+  stats.damagedArea = stats.bounds.w * stats.bounds.h;
+}
+}  // namespace
+
+namespace internal
+{
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+{
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = seed;
+  for (size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+DamageMode CurrentDamageMode()
+{
+  const internal::DamageState& damage = State();
+  return damage.offscreenDepth > 0 ? DamageMode::Off : damage.mode;
+}
+
+bool DamageVisible(const Rect& bounds)
+{
+  if (CurrentDamageMode() != DamageMode::Manual) return true;
+  if (DamageRegion().Intersects(Box::From(bounds))) return true;
+  State().frameStats.culledDraws++;
+  return false;
+}
+
+void DamageRecord(const Rect& bounds, uint64_t signature)
+{
+  if (CurrentDamageMode() != DamageMode::Auto) return;
+  State().current.push_back({Box::From(bounds), signature});
+}
+
+void ApplyDamageScissor()
+{
+  internal::DamageState& damage = State();
+  if (CurrentDamageMode() != DamageMode::Manual)
+  {
+    SetScissorEnabled(false);
+    return;
+  }
+
+  // 屏幕坐标（左上原点）转为可绘制表面像素（左下原点），向外取整
+  const Box& region = DamageRegion();
+  GLint box[4] = {0, 0, 0, 0};
+  if (!region.Empty())
+  {
+    int ww = 0, wh = 0, dw = 0, dh = 0;
+    TargetSize(&ww, &wh);
+    DrawableSize(&dw, &dh);
+    const float sx = ww > 0 ? static_cast<float>(dw) / ww : 1.0f;
+    const float sy = wh > 0 ? static_cast<float>(dh) / wh : 1.0f;
+    const GLint x0 = static_cast<GLint>(std::floor(region.x0 * sx));
+    const GLint x1 = static_cast<GLint>(std::ceil(region.x1 * sx));
+    const GLint y0 = static_cast<GLint>(std::floor((wh - region.y1) * sy));
+    const GLint y1 = static_cast<GLint>(std::ceil((wh - region.y0) * sy));
+    box[0] = x0;
+    box[1] = y0;
+    box[2] = x1 - x0;
+    box[3] = y1 - y0;
+  }
+
+  SetScissorEnabled(true);
+  if (!std::equal(box, box + 4, damage.scissor))
+  {
+    glScissor(box[0], box[1], box[2], box[3]);
+    std::copy(box, box + 4, damage.scissor);
+  }
+}
+
+void PushOffscreenTarget()
+{
+  ++State().offscreenDepth;
+}
+
+void PopOffscreenTarget()
+{
+  internal::DamageState& damage = State();
+  if (damage.offscreenDepth > 0) --damage.offscreenDepth;
+}
+
+bool EndDamageFrame()
+{
+  internal::DamageState& state = State();
+  DamageStats& stats = state.frameStats;
+  bool present = true;
+
+  switch (state.mode)
+  {
+    case DamageMode::Off:
+      break;
+
+    case DamageMode::Manual:
+    {
+      present = !state.frame.Empty();
+      FillStats(stats, DamageRegion(), state.frameRects);
+      // 交换后，新的后缓冲缺少本帧的更新
+      if (present)
+      {
+        std::rotate(state.history.rbegin(), state.history.rbegin() + 1,
+                    state.history.rend());
+        state.history[0] = state.frame;
+      }
+      state.frame = Box();
+      state.frameRects = 0;
+      state.regionDirty = true;
+      break;
+    }
+
+    case DamageMode::Auto:
+    {
+      // 按提交顺序逐条比较；不一致的新旧绘制都算作损坏
+      const std::vector<DrawRecord>& prev = state.previous;
+      const std::vector<DrawRecord>& cur = state.current;
+      Box damage;
+      uint32_t changed = 0;
+      const size_t n = std::max(prev.size(), cur.size());
+      for (size_t i = 0; i < n; ++i)
+      {
+        const DrawRecord* a = i < prev.size() ? &prev[i] : nullptr;
+        const DrawRecord* b = i < cur.size() ? &cur[i] : nullptr;
+        if (a && b && a->signature == b->signature) continue;
+        if (a) damage.Add(a->bounds);
+        if (b) damage.Add(b->bounds);
+        ++changed;
+      }
+      // 签名看不到的变化（窗口尺寸、投影、离屏内容）经由 MarkDirty 计入
+      if (!state.frame.Empty())
+      {
+        damage.Add(state.frame);
+        changed += state.frameRects;
+      }
+      present = changed > 0;
+      FillStats(stats, damage, changed);
+      state.previous.swap(state.current);
+      state.current.clear();
+      state.frame = Box();
+      state.frameRects = 0;
+      state.regionDirty = true;
+      break;
+    }
+  }
+
+  stats.presented = present;
+  if (!present) stats.skippedFrames++;
+  state.lastStats = stats;
+  state.frameStats = DamageStats{};
+  state.frameStats.skippedFrames = stats.skippedFrames;
+  return present;
+}
+}  // namespace internal
+
+// ================ 脏区跟踪 ================
+void Renderer::SetDamageTracking(DamageMode mode)
+{
+  internal::DamageState& damage = State();
+  VerifyRenderThread();
+  Flush();
+  damage.mode = mode;
+  damage.previous.clear();
+  damage.current.clear();
+  damage.history.fill(Box());
+  MarkAllDirty();
+  internal::ApplyDamageScissor();
+}
+
+DamageMode Renderer::GetDamageTracking()
+{
+  return State().mode;
+}
+
+void Renderer::MarkDirty(Rect area)
+{
+  internal::DamageState& damage = State();
+  if (area.w <= 0.0f || area.h <= 0.0f) return;
+  damage.frame.Add(Box::From(area));
+  damage.frameRects++;
+  damage.regionDirty = true;
+}
+
+void Renderer::MarkAllDirty()
+{
+  internal::DamageState& damage = State();
+  damage.frame = Box::Everything();
+  // 之前帧的区域也需要整屏重绘（如窗口尺寸改变后）
+  damage.history.fill(Box::Everything());
+  damage.frameRects++;
+  damage.regionDirty = true;
+}
+
+bool Renderer::FrameHasDamage()
+{
+  const internal::DamageState& damage = State();
+  return damage.mode != DamageMode::Manual || !damage.frame.Empty();
+}
+
+void Renderer::SetDamageBufferAge(int frames)
+{
+  internal::DamageState& damage = State();
+  damage.bufferAge = std::clamp(frames, 0, kMaxBufferAge);
+  damage.regionDirty = true;
+}
+
+DamageStats Renderer::GetDamageStats()
+{
+  return State().lastStats;
+}
+}  // namespace gfx
@@ -0,0 +1,394 @@
+#include "../include/libGfx.h"
+#include "libGfxInternal.h"
+
+#include <algorithm>
+
+namespace gfx
+{
+// ================ 字形图集 ================
+namespace internal
+{
+GlyphAtlas::~GlyphAtlas()
+{
+  for (Page& page : pages_)
+  {
+    DeleteTexture(page.texture);
+  }
+}
+
+bool GlyphAtlas::AddPage()
+{
+  // 以全透明像素初始化，填充间隙的 alpha 为 0
+  std::vector<uint8_t> clear(static_cast<size_t>(pageSize_) * pageSize_ * 4, 0);
+
+  Page page;
+  glGenTextures(1, &page.texture);
+  GLState().BindTexture(0, page.texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, pageSize_, pageSize_, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, clear.data());
+
+  GLenum err = glGetError();
+  if (err != GL_NO_ERROR)
+  {
+    std::cerr << "Failed to create glyph atlas page: " << err << std::endl;
+    DeleteTexture(page.texture);
+    return false;
+  }
+
+  page.packer.Reset(pageSize_, pageSize_);
+  page.lastUse = ++tick_;
+  pages_.push_back(page);
+  return true;
+}
+
+bool GlyphAtlas::Insert(const uint8_t* rgba, int w, int h, GLuint& texture,
+                        float& u0, float& v0, float& u1, float& v1)
+{
+  // 每个字形四周留 1 像素空隙，避免线性过滤采样到相邻字形
+  constexpr int kPadding = 1;
+  const int pw = w + kPadding, ph = h + kPadding;
+  if (pw > pageSize_ || ph > pageSize_) return false;
+
+  int x = 0, y = 0;
+  Page* target = nullptr;
+  for (Page& page : pages_)
+  {
+    if (page.packer.Pack(pw, ph, x, y))
+    {
+      target = &page;
+      break;
+    }
+  }
+  if (!target)
+  {
+    if (pages_.size() >= maxPages_) return false;
+    if (!AddPage() || !pages_.back().packer.Pack(pw, ph, x, y)) return false;
+    target = &pages_.back();
+  }
+  target->lastUse = ++tick_;
+
+  GLState().BindTexture(0, target->texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE,
+                  rgba);
+  GFX_PROFILE_COUNT(BytesUploaded, static_cast<uint64_t>(w) * h * 4);
+
+  const float inv = 1.0f / static_cast<float>(pageSize_);
+  texture = target->texture;
+  u0 = x * inv;
+  v0 = y * inv;
+  u1 = (x + w) * inv;
+  v1 = (y + h) * inv;
+  return true;
+}
+
+void GlyphAtlas::Touch(GLuint texture)
+{
+  for (Page& page : pages_)
+  {
+    if (page.texture == texture)
+    {
+      page.lastUse = ++tick_;
+      return;
+    }
+  }
+}
+
+size_t GlyphAtlas::LeastRecentlyUsed() const
+{
+  size_t lru = 0;
+  for (size_t i = 1; i < pages_.size(); ++i)
+  {
+    if (pages_[i].lastUse < pages_[lru].lastUse) lru = i;
+  }
+  return lru;
+}
+
+GLuint GlyphAtlas::EvictLeastRecentlyUsed()
+{
+  if (pages_.empty()) return 0;
+
+  Page& page = pages_[LeastRecentlyUsed()];
+  // 清空旧像素，防止新字形的填充间隙采样到残留内容
+  std::vector<uint8_t> clear(PageBytes(), 0);
+  GLState().BindTexture(0, page.texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, pageSize_, pageSize_, GL_RGBA,
+                  GL_UNSIGNED_BYTE, clear.data());
+  page.packer.Reset(pageSize_, pageSize_);
+  page.lastUse = ++tick_;
+  return page.texture;
+}
+
+std::vector<GLuint> GlyphAtlas::SetBudget(size_t bytes)
+{
+  maxPages_ = std::max<size_t>(1, bytes / PageBytes());
+
+  std::vector<GLuint> removed;
+  while (pages_.size() > maxPages_)
+  {
+    const size_t lru = LeastRecentlyUsed();
+    removed.push_back(pages_[lru].texture);
+    DeleteTexture(pages_[lru].texture);
+    pages_.erase(pages_.begin() + lru);
+  }
+  return removed;
+}
+}  // namespace internal
+
+// UTF-8 解码一个码点并前移 p；非法序列返回 U+FFFD 并跳过一个字节
+static char32_t DecodeUtf8(const char*& p, const char* end)
+{
+  const unsigned char c = static_cast<unsigned char>(*p++);
+  if (c < 0x80) return c;
+
+  int extra;
+  char32_t cp;
+  if ((c & 0xE0) == 0xC0) { extra = 1; cp = c & 0x1F; }
+  else if ((c & 0xF0) == 0xE0) { extra = 2; cp = c & 0x0F; }
+  else if ((c & 0xF8) == 0xF0) { extra = 3; cp = c & 0x07; }
+  else return 0xFFFD;
+
+  if (end - p < extra) return 0xFFFD;
+  for (int i = 0; i < extra; ++i)
+  {
+    const unsigned char cc = static_cast<unsigned char>(p[i]);
+    if ((cc & 0xC0) != 0x80) return 0xFFFD;
+    cp = (cp << 6) | (cc & 0x3F);
+  }
+  p += extra;
+
+  // 拒绝超长编码、代理项与越界码点
+  static const char32_t kMin[4] = {0, 0x80, 0x800, 0x10000};
+  if (cp < kMin[extra] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+    return 0xFFFD;
+  return cp;
+}
+
+// ================ Font ================
+constexpr size_t kDefaultGlyphCacheBudget = 16u << 20;
+
+Font::Font() = default;
+
+Font::~Font()
+{
+    atlas_.reset();
+    if (face_) FT_Done_Face(face_);
+    if (library_) FT_Done_FreeType(library_);
+}
+
+Font* Font::Load(const std::string& path, int size,Color color)
+{
+    FT_Library library;
+    FT_Face face;
+    FT_Error error;
+
+    // 1. 初始化 FreeType
+    error = FT_Init_FreeType(&library);
+    if (error) {
+        fprintf(stderr, "INFO :Unable to initialize FreeType library\n");
+        return nullptr;
+    }
+
+    // 2. 加载字体文件
+    error = FT_New_Face(library, path.c_str(), 0, &face);
+    if (error) {
+        fprintf(stderr, "INFO :Unable to load font file: %s\n", path.c_str());
+        FT_Done_FreeType(library);
+        return nullptr;
+    }
+
+    // 3. 设置字体大小
+    error = FT_Set_Pixel_Sizes(face, 0, size);
+    if (error) {
+        fprintf(stderr, "INFO :Unable to set font size\n");
+        FT_Done_Face(face);
+        FT_Done_FreeType(library);
+        return nullptr;
+    }
+
+    // 4. 创建 Font 对象，保留 FT_Face 以便按需光栅化；图集页尺寸随字号增长
+    Font* font = new Font();
+    font->size=size;
+    font->library_ = library;
+    font->face_ = face;
+    font->color_ = color;
+    int pageSize = 512;
+    while (pageSize < size * 8 && pageSize < 4096) pageSize *= 2;
+    font->atlas_.reset(new internal::GlyphAtlas(pageSize, kDefaultGlyphCacheBudget));
+
+    // 5. 预热可打印 ASCII，其余字符首次使用时再光栅化
+    for (char32_t c = 32; c < 127; ++c) {
+        font->GetGlyph(c);
+    }
+    font->stats_.misses = 0;
+
+    return font;
+}
+
+void Font::Release(Font* font)
+{
+    // 图集页纹理随 GlyphAtlas 析构释放，FT_Face 随 Font 析构关闭
+    delete font;
+}
+
+bool Font::Rasterize(char32_t codepoint, Glyph& glyph) const
+{
+    if (FT_Load_Char(face_, codepoint, FT_LOAD_RENDER)) {
+        fprintf(stderr, "INFO :Unable to load character U+%04X\n", (unsigned)codepoint);
+        return false;
+    }
+    GFX_PROFILE_COUNT(GlyphsRasterized, 1);
+
+    FT_GlyphSlot slot = face_->glyph;
+    FT_Bitmap bitmap = slot->bitmap;
+
+    int width = bitmap.width;
+    int height = bitmap.rows;
+
+    glyph = Glyph(static_cast<int>(slot->bitmap_left),
+                  static_cast<int>(slot->bitmap_top),
+                  static_cast<int>(slot->advance.x >> 6),
+                  0,
+                  width,
+                  height);
+
+    // 空白字形（如空格）只保留度量，不占图集空间
+    if (width <= 0 || height <= 0) return true;
+
+    // 转换成 RGBA：字体颜色 + 灰度做透明度
+    scratch_.resize(static_cast<size_t>(width) * height * 4);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = bitmap.buffer + y * bitmap.pitch;
+        for (int x = 0; x < width; ++x) {
+            int i = y * width + x;
+            scratch_[i * 4 + 0] = color_.r;
+            scratch_[i * 4 + 1] = color_.g;
+            scratch_[i * 4 + 2] = color_.b;
+            scratch_[i * 4 + 3] = row[x];
+        }
+    }
+
+    if (atlas_->Insert(scratch_.data(), width, height, glyph.texture,
+                       glyph.u0, glyph.v0, glyph.u1, glyph.v1)) {
+        return true;
+    }
+
+    // 图集已达预算：回收最久未用的页。待提交批次可能引用该页，需先提交
+    internal::FlushBatch(FlushReason::Interleave);
+    DropPageGlyphs(atlas_->EvictLeastRecentlyUsed());
+    stats_.evictions++;
+
+    if (!atlas_->Insert(scratch_.data(), width, height, glyph.texture,
+                        glyph.u0, glyph.v0, glyph.u1, glyph.v1)) {
+        fprintf(stderr, "INFO :Glyph U+%04X does not fit an atlas page\n", (unsigned)codepoint);
+        return false;
+    }
+    return true;
+}
+
+void Font::DropPageGlyphs(GLuint texture) const
+{
+    for (auto it = glyphs.begin(); it != glyphs.end();) {
+        if (it->second.texture == texture) it = glyphs.erase(it);
+        else ++it;
+    }
+}
+
+const Font::Glyph* Font::GetGlyph(char32_t codepoint) const
+{
+  auto it = glyphs.find(codepoint);
+  if (it != glyphs.end())
+  {
+    stats_.hits++;
+    if (it->second.texture) atlas_->Touch(it->second.texture);
+    return &it->second;
+  }
+
+  stats_.misses++;
+  Glyph glyph;
+  if (!Rasterize(codepoint, glyph)) return nullptr;
+  return &(glyphs[codepoint] = glyph);
+}
+
+size_t Font::GetAtlasPageCount() const
+{
+  return atlas_ ? atlas_->PageCount() : 0;
+}
+
+void Font::SetCacheBudget(size_t bytes)
+{
+  // DeleteTexture 会先提交引用这些页面的批次
+  for (GLuint texture : atlas_->SetBudget(bytes)) {
+    DropPageGlyphs(texture);
+    stats_.evictions++;
+  }
+}
+
+Font::CacheStats Font::GetCacheStats() const
+{
+  CacheStats stats = stats_;
+  stats.pages = atlas_->PageCount();
+  stats.bytes = stats.pages * atlas_->PageBytes();
+  return stats;
+}
+
+// ================ 文本绘制 ================
+void Renderer::DrawText(const std::string& text, Point pos, Font* font)
+{
+    if (!font) return;
+    GFX_PROFILE_ZONE("Renderer::DrawText(Font)");
+
+    // 脏区跟踪：Manual 模式逐字形剔除，Auto 模式以整段文本的包围盒记录
+    const DamageMode damage = internal::CurrentDamageMode();
+    const Point origin = pos;
+    float x0 = pos.x, y0 = pos.y, x1 = pos.x, y1 = pos.y;
+
+    // 所有字形四边形进入批处理缓冲；同一图集页内的字形合并为一次绘制
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end)
+    {
+        char32_t codepoint = DecodeUtf8(p, end);
+        const Font::Glyph* glyph = font->GetGlyph(codepoint);
+        if (!glyph) continue;
+
+        if (glyph->texture != 0)
+        {
+            // 计算字符纹理左上角位置（相对于基线 pos）
+            gfx::Rect dest(
+                static_cast<float>(pos.x + glyph->bitmap_left),
+                static_cast<float>(pos.y - glyph->bitmap_top),
+                static_cast<float>(glyph->w),
+                static_cast<float>(glyph->h)
+            );
+            x0 = std::min(x0, dest.x);
+            y0 = std::min(y0, dest.y);
+            x1 = std::max(x1, dest.x + dest.w);
+            y1 = std::max(y1, dest.y + dest.h);
+            if (damage != DamageMode::Manual || internal::DamageVisible(dest))
+                internal::PushQuad(glyph->texture, dest, glyph->u0, glyph->v0,
+                                   glyph->u1, glyph->v1, White);
+        }
+
+        // 移动到下一个字符位置
+        pos.x += glyph->advance_x;
+    }
+
+    if (damage == DamageMode::Auto)
+    {
+        uint64_t h = internal::HashBytes(text.data(), text.size());
+        h = internal::HashBytes(&origin, sizeof origin, h);
+        h = internal::HashBytes(&font, sizeof font, h);
+        internal::DamageRecord(Rect(x0, y0, x1 - x0, y1 - y0), h);
+    }
+
+    // 非批处理模式下立即提交整段文本
+    if (!IsBatching()) internal::FlushBatch(FlushReason::Interleave);
+}
+
+}  // namespace gfx
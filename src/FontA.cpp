@@ -1,4 +1,5 @@
 #include "../include/libGfx.h"
+#include "libGfxInternal.h"
 namespace gfx
 {
 FontA* FontA::Load(const std::string& path, int size)
@@ -18,6 +19,7 @@ void FontA::Release(FontA* font)
 {
   if (font && font->font_)
   {
+    InvalidateCache(font);
     TTF_CloseFont(font->font_);
     delete font;
   }
@@ -25,8 +27,21 @@ void FontA::Release(FontA* font)
 
 Texture* FontA::GetTextTexture(FontA* font, const char* text, Color color)
 {
-  if (!font || !text) return {};
-  if (font->TextCache == text) return font->TextureCached;
+  if (!font || !text || !*text) return {};
+  GFX_PROFILE_ZONE("FontA::GetTextTexture");
+
+  TextKey key{text, static_cast<uint32_t>(color),
+              TTF_GetFontStyle(font->font_) |
+                  (TTF_GetFontOutline(font->font_) << 8)};
+  auto found = font->entries_.find(key);
+  if (found != font->entries_.end())
+  {
+    // 命中：移到队首
+    font->lru_.splice(font->lru_.begin(), font->lru_, found->second);
+    font->stats_.hits++;
+    return found->second->texture;
+  }
+  font->stats_.misses++;
 
   SDL_Color sdlColor = {color.r, color.g, color.b, color.a};
   SDL_Surface* surface = TTF_RenderText_Blended(font->font_, text, sdlColor);
@@ -49,43 +64,88 @@ Texture* FontA::GetTextTexture(FontA* font, const char* text, Color color)
 
   GLuint textureID;
   glGenTextures(1, &textureID);
-  glBindTexture(GL_TEXTURE_2D, textureID);
+  internal::GLState().BindTexture(0, textureID);
 
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  // 文本按原尺寸绘制，不需要 mipmap
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, converted->pitch / 4);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, converted->w, converted->h, 0,
                GL_RGBA, GL_UNSIGNED_BYTE, converted->pixels);
-  glGenerateMipmap(GL_TEXTURE_2D);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 
+  const int width = converted->w, height = converted->h;
   SDL_FreeSurface(converted);
 
   GLenum err = glGetError();
   if (err != GL_NO_ERROR)
   {
     std::cerr << "Failed to upload texture: " << err << std::endl;
-    glDeleteTextures(1, &textureID);
+    internal::DeleteTexture(textureID);
     return {};
   }
 
-  // 释放旧纹理和旧对象
-  if (font->TextureCached)
+  const size_t bytes = static_cast<size_t>(width) * height * 4;
+  GFX_PROFILE_COUNT(TextTexturesCreated, 1);
+  GFX_PROFILE_COUNT(BytesUploaded, bytes);
+  font->EvictToBudget(font->budget_ > bytes ? font->budget_ - bytes : 0);
+
+  Texture* texture = new Texture{textureID, width, height};
+  font->lru_.push_front({std::move(key), texture, bytes});
+  font->entries_.emplace(font->lru_.front().key, font->lru_.begin());
+  font->stats_.bytes += bytes;
+  return texture;
+}
+
+void FontA::EvictToBudget(size_t budget)
+{
+  while (!lru_.empty() && stats_.bytes > budget)
+  {
+    CacheEntry& victim = lru_.back();
+    stats_.bytes -= victim.bytes;
+    stats_.evictions++;
+    delete victim.texture;  // ~Texture 释放 GL 纹理
+    entries_.erase(victim.key);
+    lru_.pop_back();
+  }
+}
+
+void FontA::SetCacheBudget(FontA* font, size_t bytes)
+{
+  if (!font) return;
+  font->budget_ = bytes;
+  font->EvictToBudget(bytes);
+}
+
+void FontA::InvalidateCache(FontA* font)
+{
+  if (!font) return;
+  for (CacheEntry& entry : font->lru_)
   {
-    glDeleteTextures(1, &font->TextureCached->id);
-    delete font->TextureCached;
+    delete entry.texture;
   }
+  font->lru_.clear();
+  font->entries_.clear();
+  font->stats_.bytes = 0;
+}
 
-  font->TextureCached = new Texture{textureID, converted->w, converted->h};
-  return font->TextureCached;
+FontA::CacheStats FontA::GetCacheStats(const FontA* font)
+{
+  if (!font) return {};
+  CacheStats stats = font->stats_;
+  stats.entries = font->entries_.size();
+  return stats;
 }
 
 void Renderer::DrawText(const std::string& text, Point pos, FontA* font,
                         Color color, float scale, float rotation)
 {
-    Texture* texture = font->GetTextTexture(font, text.c_str(), color);  // 保持为指针类型
-    if (texture->id == 0)
+    GFX_PROFILE_ZONE("Renderer::DrawText(FontA)");
+    Texture* texture = font->GetTextTexture(font, text.c_str(), color);  // 静态标签命中缓存
+    if (!texture || texture->id == 0)
     {
         return;
     }
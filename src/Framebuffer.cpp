@@ -0,0 +1,180 @@
+#include "libGfxInternal.h"
+
+namespace gfx
+{
+namespace advanced
+{
+
+// ================ Framebuffer ================
+Framebuffer::Framebuffer(int width, int height, bool depth)
+    : width_(width), height_(height), hasDepth_(depth)
+{
+  VerifyRenderThread();
+  Allocate();
+}
+
+Framebuffer::~Framebuffer()
+{
+  if (bound_) Unbind();
+  Release();
+}
+
+bool Framebuffer::Allocate()
+{
+  if (width_ <= 0 || height_ <= 0)
+  {
+    std::cerr << "Invalid framebuffer dimensions: " << width_ << "x"
+              << height_ << std::endl;
+    return false;
+  }
+
+  colorTex.reset(Renderer::CreateTexture(width_, height_));
+  if (!colorTex) return false;
+
+  internal::GLStateCache& gl = internal::GLState();
+  const GLuint previous = gl.BoundFramebuffer();
+
+  glGenFramebuffers(1, &fbo);
+  gl.BindFramebuffer(fbo);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         colorTex->id, 0);
+  if (hasDepth_)
+  {
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width_,
+                          height_);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                              GL_RENDERBUFFER, depthBuffer);
+  }
+
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  if (status == GL_FRAMEBUFFER_COMPLETE)
+  {
+    // 新纹理内容未定义，清为透明（离屏目标不受脏区裁剪影响）
+    internal::PushOffscreenTarget();
+    internal::ApplyDamageScissor();
+    internal::PopOffscreenTarget();
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT |
+            (hasDepth_ ? GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT : 0));
+  }
+  gl.BindFramebuffer(previous);
+
+  if (status != GL_FRAMEBUFFER_COMPLETE)
+  {
+    std::cerr << "Framebuffer incomplete: 0x" << std::hex << status
+              << std::dec << std::endl;
+    Release();
+    return false;
+  }
+  return true;
+}
+
+void Framebuffer::Release()
+{
+  colorTex.reset();  // ~Texture 先提交仍在采样它的批次
+  if (depthBuffer)
+  {
+    glDeleteRenderbuffers(1, &depthBuffer);
+    depthBuffer = 0;
+  }
+  if (fbo)
+  {
+    internal::GLState().OnFramebufferDeleted(fbo);
+    glDeleteFramebuffers(1, &fbo);
+    fbo = 0;
+  }
+}
+
+void Framebuffer::Bind()
+{
+  VerifyRenderThread();
+  if (!fbo || bound_) return;
+
+  // 之前的绘制仍属于旧目标
+  internal::FlushBatch(FlushReason::Interleave);
+
+  internal::GLStateCache& gl = internal::GLState();
+  prevFramebuffer_ = gl.BoundFramebuffer();
+  glGetIntegerv(GL_VIEWPORT, prevViewport_);
+  prevProjection_ = Renderer::GetProjection();
+
+  gl.BindFramebuffer(fbo);
+  internal::PushOffscreenTarget();
+  glViewport(0, 0, width_, height_);
+  // 翻转 y：屏幕顶边写入纹理第 0 行，与 DrawTexture 的 v=0 对应
+  Renderer::SetProjection(glm::ortho(0.0f, static_cast<float>(width_), 0.0f,
+                                     static_cast<float>(height_)));
+  bound_ = true;
+}
+
+void Framebuffer::Unbind()
+{
+  VerifyRenderThread();
+  if (!bound_) return;
+
+  internal::FlushBatch(FlushReason::Interleave);
+
+  internal::GLState().BindFramebuffer(prevFramebuffer_);
+  glViewport(prevViewport_[0], prevViewport_[1], prevViewport_[2],
+             prevViewport_[3]);
+  // 仍处于离屏状态时恢复投影，不会被当作屏幕投影的变化
+  Renderer::SetProjection(prevProjection_);
+  internal::PopOffscreenTarget();
+  // 纹理内容变了而名字与绘制矩形不变，Auto 的签名比较看不出来
+  if (internal::CurrentDamageMode() == DamageMode::Auto)
+    Renderer::MarkAllDirty();
+  bound_ = false;
+}
+
+bool Framebuffer::Resize(int width, int height)
+{
+  VerifyRenderThread();
+  if (fbo && width == width_ && height == height_) return true;
+
+  const bool wasBound = bound_;
+  if (wasBound) Unbind();
+  Release();
+  width_ = width;
+  height_ = height;
+  const bool ok = Allocate();
+  if (ok && wasBound) Bind();
+  return ok;
+}
+
+// ================ CachedLayer ================
+CachedLayer::CachedLayer(int width, int height, bool depth)
+    : framebuffer_(width, height, depth)
+{
+}
+
+void CachedLayer::Draw(Rect dest, const std::function<void()>& redraw)
+{
+  if (!framebuffer_.IsValid()) return;
+
+  if (dirty_)
+  {
+    framebuffer_.Bind();
+    Renderer::Clear(Color(0x00000000u));
+    if (redraw) redraw();
+    framebuffer_.Unbind();
+    dirty_ = false;
+  }
+
+  // 层内容已预乘 alpha
+  const BlendMode previous = Renderer::GetBlendMode();
+  Renderer::SetBlendMode(BlendMode::Premultiplied);
+  Renderer::DrawTexture(framebuffer_.GetColorTexture(), dest);
+  Renderer::SetBlendMode(previous);
+}
+
+bool CachedLayer::Resize(int width, int height)
+{
+  dirty_ = true;
+  return framebuffer_.Resize(width, height);
+}
+
+}  // namespace advanced
+}  // namespace gfx
@@ -0,0 +1,242 @@
+#include "libGfxInternal.h"
+
+#include <cstring>
+
+namespace gfx
+{
+namespace internal
+{
+
+void GLStateCache::UseProgram(GLuint program)
+{
+  if (program == program_)
+  {
+    stats.program.skipped++;
+    return;
+  }
+  glUseProgram(program);
+  program_ = program;
+  currentUniforms_ = &uniforms_[program];
+  stats.program.issued++;
+}
+
+void GLStateCache::BindVertexArray(GLuint vao)
+{
+  if (vao == vao_)
+  {
+    stats.vertexArray.skipped++;
+    return;
+  }
+  glBindVertexArray(vao);
+  vao_ = vao;
+  stats.vertexArray.issued++;
+}
+
+void GLStateCache::BindTexture(GLuint unit, GLuint texture)
+{
+  if (sharedDeletions_)
+  {
+    // 共享组内其它上下文删除过纹理：名字可能已被回收，缓存的绑定不再可信
+    const uint32_t deletions =
+        sharedDeletions_->load(std::memory_order_acquire);
+    if (deletions != seenDeletions_)
+    {
+      textures_.fill(kUnknown);
+      seenDeletions_ = deletions;
+    }
+  }
+  if (unit >= kMaxTextureUnits)
+  {
+    // 超出跟踪范围的单元直接下发
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    activeUnit_ = unit;
+    stats.texture.issued++;
+    GFX_PROFILE_COUNT(TextureBinds, 1);
+    return;
+  }
+  // 即使绑定可跳过也切换活动单元：调用方随后的 glTexImage2D 等编辑调用
+  // 作用于活动单元，不能落到其他单元上的纹理
+  if (activeUnit_ != unit)
+  {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    activeUnit_ = unit;
+  }
+  if (textures_[unit] == texture)
+  {
+    stats.texture.skipped++;
+    return;
+  }
+  glBindTexture(GL_TEXTURE_2D, texture);
+  textures_[unit] = texture;
+  stats.texture.issued++;
+  GFX_PROFILE_COUNT(TextureBinds, 1);
+}
+
+void GLStateCache::SetBlendMode(BlendMode mode)
+{
+  if (blendKnown_ && mode == blend_)
+  {
+    stats.blend.skipped++;
+    return;
+  }
+  switch (mode)
+  {
+    case BlendMode::None:
+      glDisable(GL_BLEND);
+      break;
+    case BlendMode::Alpha:
+      // alpha 通道按 "over" 累积，透明离屏目标里得到正确覆盖率
+      glEnable(GL_BLEND);
+      glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                          GL_ONE_MINUS_SRC_ALPHA);
+      break;
+    case BlendMode::Additive:
+      glEnable(GL_BLEND);
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+      break;
+    case BlendMode::Premultiplied:
+      glEnable(GL_BLEND);
+      glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+      break;
+  }
+  blend_ = mode;
+  blendKnown_ = true;
+  stats.blend.issued++;
+}
+
+void GLStateCache::BindFramebuffer(GLuint framebuffer)
+{
+  if (framebuffer == framebuffer_)
+  {
+    stats.framebuffer.skipped++;
+    return;
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  framebuffer_ = framebuffer;
+  stats.framebuffer.issued++;
+}
+
+GLuint GLStateCache::BoundFramebuffer()
+{
+  if (framebuffer_ == kUnknown)
+  {
+    GLint bound = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &bound);
+    framebuffer_ = static_cast<GLuint>(bound);
+  }
+  return framebuffer_;
+}
+
+bool GLStateCache::UniformUnchanged(GLint location, const void* value,
+                                    uint8_t size)
+{
+  // 未通过 UseProgram 选定程序时无法判断，总是下发
+  if (location < 0 || !currentUniforms_) return false;
+
+  UniformTable& table = *currentUniforms_;
+  if (static_cast<size_t>(location) >= table.size()) table.resize(location + 1);
+
+  UniformValue& slot = table[location];
+  const size_t bytes = size * sizeof(uint32_t);
+  if (slot.size == size && std::memcmp(slot.data, value, bytes) == 0)
+  {
+    stats.uniform.skipped++;
+    return true;
+  }
+  std::memcpy(slot.data, value, bytes);
+  slot.size = size;
+  return false;
+}
+
+void GLStateCache::Uniform1i(GLint location, GLint value)
+{
+  if (UniformUnchanged(location, &value, 1)) return;
+  glUniform1i(location, value);
+  stats.uniform.issued++;
+}
+
+void GLStateCache::Uniform1f(GLint location, float value)
+{
+  if (UniformUnchanged(location, &value, 1)) return;
+  glUniform1f(location, value);
+  stats.uniform.issued++;
+}
+
+void GLStateCache::Uniform2f(GLint location, float x, float y)
+{
+  const float v[2] = {x, y};
+  if (UniformUnchanged(location, v, 2)) return;
+  glUniform2fv(location, 1, v);
+  stats.uniform.issued++;
+}
+
+void GLStateCache::Uniform4f(GLint location, float x, float y, float z,
+                             float w)
+{
+  const float v[4] = {x, y, z, w};
+  if (UniformUnchanged(location, v, 4)) return;
+  glUniform4fv(location, 1, v);
+  stats.uniform.issued++;
+}
+
+void GLStateCache::UniformMatrix4fv(GLint location, const float* value)
+{
+  if (UniformUnchanged(location, value, 16)) return;
+  glUniformMatrix4fv(location, 1, GL_FALSE, value);
+  stats.uniform.issued++;
+}
+
+void GLStateCache::OnTextureDeleted(GLuint texture)
+{
+  // glDeleteTextures 会把绑定该名字的单元重置为 0
+  for (GLuint& bound : textures_)
+  {
+    if (bound == texture) bound = 0;
+  }
+  if (sharedDeletions_)
+  {
+    // 本上下文的缓存已更新；期间其它上下文的删除仍留待下次绑定时处理
+    const uint32_t before =
+        sharedDeletions_->fetch_add(1, std::memory_order_acq_rel);
+    if (before == seenDeletions_) seenDeletions_ = before + 1;
+  }
+}
+
+void GLStateCache::ShareTextureNames(std::atomic<uint32_t>* deletions)
+{
+  sharedDeletions_ = deletions;
+  seenDeletions_ = deletions ? deletions->load(std::memory_order_acquire) : 0;
+  textures_.fill(kUnknown);
+}
+
+void GLStateCache::OnFramebufferDeleted(GLuint framebuffer)
+{
+  // 删除当前绑定的 FBO 会回退到默认帧缓冲
+  if (framebuffer_ == framebuffer) framebuffer_ = 0;
+}
+
+void GLStateCache::OnProgramDeleted(GLuint program)
+{
+  uniforms_.erase(program);
+  if (program_ == program)
+  {
+    program_ = kUnknown;
+    currentUniforms_ = nullptr;
+  }
+}
+
+void GLStateCache::Invalidate()
+{
+  program_ = kUnknown;
+  vao_ = kUnknown;
+  framebuffer_ = kUnknown;
+  activeUnit_ = kUnknown;
+  textures_.fill(kUnknown);
+  blendKnown_ = false;
+  uniforms_.clear();
+  currentUniforms_ = nullptr;
+}
+
+}  // namespace internal
+}  // namespace gfx
@@ -0,0 +1,467 @@
+#include "libGfxInternal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+#ifdef GFX_HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+namespace gfx
+{
+namespace internal
+{
+constexpr int kReadbackBuffers = 2;
+
+struct HeadlessState
+{
+  int width = 0;
+  int height = 0;
+
+  // 上下文：EGL 或隐藏的 SDL 窗口（未编译 EGL 或 EGL 初始化失败时）
+#ifdef GFX_HAVE_EGL
+  EGLContext context = EGL_NO_CONTEXT;
+  EGLSurface surface = EGL_NO_SURFACE;
+#endif
+  SDL_Window* hiddenWindow = nullptr;
+  SDL_GLContext sdlContext = nullptr;
+
+  // 离屏目标与回读
+  GLuint fbo = 0;
+  GLuint color = 0;
+  GLuint pixelBuffers[kReadbackBuffers] = {};
+  int next = 0;             // 下一次回读写入的 PBO
+  std::deque<int> pending;  // 已排队、未读取的 PBO（先进先出）
+};
+
+void HeadlessStateDeleter::operator()(HeadlessState* state) const
+{
+  delete state;
+}
+}  // namespace internal
+
+namespace
+{
+using internal::HeadlessState;
+using internal::kReadbackBuffers;
+
+// 调用方保证当前上下文是无窗口上下文
+HeadlessState& State()
+{
+  return *internal::Ctx().headless;
+}
+
+#ifdef GFX_HAVE_EGL
+// 所有无窗口上下文共用一个 EGL display，最后一个上下文销毁时终止
+struct EglDisplay
+{
+  std::mutex mutex;
+  EGLDisplay display = EGL_NO_DISPLAY;
+  EGLConfig config = nullptr;
+  bool surfaceless = false;
+  int refs = 0;
+};
+EglDisplay s_egl;
+
+bool HasExtension(const char* list, const char* name)
+{
+  if (!list) return false;
+  const size_t len = std::strlen(name);
+  for (const char* p = std::strstr(list, name); p; p = std::strstr(p + 1, name))
+  {
+    if ((p == list || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0'))
+      return true;
+  }
+  return false;
+}
+
+// 需持有 s_egl.mutex
+bool AcquireEglDisplay()
+{
+  if (s_egl.refs > 0)
+  {
+    ++s_egl.refs;
+    return true;
+  }
+
+  // 优先使用 Mesa 的 surfaceless 平台，不依赖 X11/Wayland 或 GPU 设备
+  EGLDisplay display = EGL_NO_DISPLAY;
+  const char* clientExts = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+      eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (getPlatformDisplay &&
+      HasExtension(clientExts, "EGL_MESA_platform_surfaceless"))
+  {
+    display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                 EGL_DEFAULT_DISPLAY, nullptr);
+  }
+  if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+  EGLint major = 0, minor = 0;
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+  {
+    SDL_Log("EGL initialization failed: 0x%x", eglGetError());
+    return false;
+  }
+  if (!eglBindAPI(EGL_OPENGL_API))
+  {
+    SDL_Log("EGL has no desktop OpenGL support");
+    eglTerminate(display);
+    return false;
+  }
+
+  // 无 surfaceless 扩展时退回 1x1 pbuffer，只用于让上下文成为当前
+  const bool surfaceless = HasExtension(eglQueryString(display, EGL_EXTENSIONS),
+                                        "EGL_KHR_surfaceless_context");
+  const EGLint configAttribs[] = {
+      EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+      EGL_NONE};
+  EGLConfig config = nullptr;
+  EGLint count = 0;
+  if (!eglChooseConfig(display, configAttribs, &config, 1, &count) ||
+      count == 0)
+  {
+    SDL_Log("No suitable EGL config");
+    eglTerminate(display);
+    return false;
+  }
+
+  s_egl.display = display;
+  s_egl.config = config;
+  s_egl.surfaceless = surfaceless;
+  s_egl.refs = 1;
+  return true;
+}
+
+// 需持有 s_egl.mutex
+void ReleaseEglDisplay()
+{
+  if (--s_egl.refs > 0) return;
+  eglTerminate(s_egl.display);
+  s_egl.display = EGL_NO_DISPLAY;
+  s_egl.config = nullptr;
+}
+
+bool CreateEglContext(HeadlessState& headless, EGLContext shareWith)
+{
+  std::lock_guard<std::mutex> lock(s_egl.mutex);
+  if (!AcquireEglDisplay()) return false;
+
+  // eglBindAPI 是线程级状态，每个创建线程都要设置
+  eglBindAPI(EGL_OPENGL_API);
+  const EGLint coreAttribs[] = {
+      EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE};
+  EGLContext context =
+      eglCreateContext(s_egl.display, s_egl.config, shareWith, coreAttribs);
+  if (context == EGL_NO_CONTEXT)
+    context = eglCreateContext(s_egl.display, s_egl.config, shareWith, nullptr);
+  if (context == EGL_NO_CONTEXT)
+  {
+    SDL_Log("Failed to create EGL context: 0x%x", eglGetError());
+    ReleaseEglDisplay();
+    return false;
+  }
+
+  EGLSurface surface = EGL_NO_SURFACE;
+  if (!s_egl.surfaceless)
+  {
+    const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+    surface = eglCreatePbufferSurface(s_egl.display, s_egl.config,
+                                      pbufferAttribs);
+    if (surface == EGL_NO_SURFACE)
+    {
+      SDL_Log("Failed to create EGL pbuffer: 0x%x", eglGetError());
+      eglDestroyContext(s_egl.display, context);
+      ReleaseEglDisplay();
+      return false;
+    }
+  }
+
+  headless.context = context;
+  headless.surface = surface;
+  return true;
+}
+#endif
+
+bool CreateSdlContext(HeadlessState& headless, RenderContext* shareWith)
+{
+  headless.hiddenWindow =
+      SDL_CreateWindow("libGfx", SDL_WINDOWPOS_UNDEFINED,
+                       SDL_WINDOWPOS_UNDEFINED, 1, 1,
+                       SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  if (!headless.hiddenWindow)
+  {
+    SDL_Log("Failed to create hidden window: %s", SDL_GetError());
+    return false;
+  }
+  // SDL 与创建时的当前上下文共享对象
+  if (shareWith && !RenderContext::MakeCurrent(shareWith))
+  {
+    SDL_DestroyWindow(headless.hiddenWindow);
+    headless.hiddenWindow = nullptr;
+    return false;
+  }
+  SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, shareWith ? 1 : 0);
+  headless.sdlContext = SDL_GL_CreateContext(headless.hiddenWindow);
+  SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+  if (!headless.sdlContext)
+  {
+    SDL_Log("Failed to create GL context: %s", SDL_GetError());
+    SDL_DestroyWindow(headless.hiddenWindow);
+    headless.hiddenWindow = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void DestroyContext(HeadlessState& headless)
+{
+#ifdef GFX_HAVE_EGL
+  if (headless.context != EGL_NO_CONTEXT)
+  {
+    std::lock_guard<std::mutex> lock(s_egl.mutex);
+    eglMakeCurrent(s_egl.display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                   EGL_NO_CONTEXT);
+    if (headless.surface != EGL_NO_SURFACE)
+      eglDestroySurface(s_egl.display, headless.surface);
+    eglDestroyContext(s_egl.display, headless.context);
+    headless.context = EGL_NO_CONTEXT;
+    headless.surface = EGL_NO_SURFACE;
+    ReleaseEglDisplay();
+  }
+#endif
+  if (headless.sdlContext)
+  {
+    SDL_GL_MakeCurrent(headless.hiddenWindow, nullptr);
+    SDL_GL_DeleteContext(headless.sdlContext);
+    headless.sdlContext = nullptr;
+  }
+  if (headless.hiddenWindow)
+  {
+    SDL_DestroyWindow(headless.hiddenWindow);
+    headless.hiddenWindow = nullptr;
+  }
+}
+
+void ReleaseTarget(HeadlessState& headless)
+{
+  internal::FlushBatch(FlushReason::Explicit);
+  if (headless.pixelBuffers[0])
+  {
+    glDeleteBuffers(kReadbackBuffers, headless.pixelBuffers);
+    std::fill(std::begin(headless.pixelBuffers),
+              std::end(headless.pixelBuffers), 0u);
+  }
+  headless.pending.clear();
+  headless.next = 0;
+  if (headless.color)
+  {
+    glDeleteRenderbuffers(1, &headless.color);
+    headless.color = 0;
+  }
+  if (headless.fbo)
+  {
+    internal::GLState().OnFramebufferDeleted(headless.fbo);
+    glDeleteFramebuffers(1, &headless.fbo);
+    headless.fbo = 0;
+  }
+}
+}  // namespace
+
+// ================ 内部接口 ================
+namespace internal
+{
+bool IsHeadless()
+{
+  return Ctx().headless != nullptr;
+}
+
+bool HeadlessSize(int* width, int* height)
+{
+  const HeadlessState* headless = Ctx().headless.get();
+  if (!headless) return false;
+  *width = headless->width;
+  *height = headless->height;
+  return true;
+}
+
+bool CreateHeadlessContext(ContextState& ctx, const ContextState* shareWith)
+{
+  std::unique_ptr<HeadlessState, HeadlessStateDeleter> headless(
+      new HeadlessState());
+
+  // EGL 上下文只能与 EGL 上下文共享，与窗口上下文共享时走 SDL
+  bool created = false;
+#ifdef GFX_HAVE_EGL
+  if (!shareWith || shareWith->headless)
+  {
+    created = CreateEglContext(
+        *headless, shareWith ? shareWith->headless->context : EGL_NO_CONTEXT);
+  }
+#endif
+  if (!created &&
+      !CreateSdlContext(*headless, shareWith ? shareWith->owner : nullptr))
+    return false;
+
+  ctx.headless = std::move(headless);
+  return true;
+}
+
+bool MakeHeadlessCurrent(HeadlessState& headless, bool bind)
+{
+#ifdef GFX_HAVE_EGL
+  if (headless.context != EGL_NO_CONTEXT)
+  {
+    return bind ? eglMakeCurrent(s_egl.display, headless.surface,
+                                 headless.surface, headless.context)
+                : eglMakeCurrent(s_egl.display, EGL_NO_SURFACE,
+                                 EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  }
+#endif
+  return SDL_GL_MakeCurrent(headless.hiddenWindow,
+                            bind ? headless.sdlContext : nullptr) == 0;
+}
+
+bool AllocateHeadlessTarget(int width, int height)
+{
+  HeadlessState& headless = State();
+  glGenRenderbuffers(1, &headless.color);
+  glBindRenderbuffer(GL_RENDERBUFFER, headless.color);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glGenFramebuffers(1, &headless.fbo);
+  GLState().BindFramebuffer(headless.fbo);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, headless.color);
+  const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE)
+  {
+    std::cerr << "Headless framebuffer incomplete: 0x" << std::hex << status
+              << std::dec << std::endl;
+    ReleaseTarget(headless);
+    return false;
+  }
+
+  const GLsizeiptr bytes = static_cast<GLsizeiptr>(width) * height * 4;
+  glGenBuffers(kReadbackBuffers, headless.pixelBuffers);
+  for (GLuint buffer : headless.pixelBuffers)
+  {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  headless.width = width;
+  headless.height = height;
+  glViewport(0, 0, width, height);
+  Ctx().projection = glm::ortho(0.0f, static_cast<float>(width),
+                                static_cast<float>(height), 0.0f);
+  return true;
+}
+
+void QueueHeadlessReadback()
+{
+  HeadlessState& headless = State();
+  if (!headless.fbo) return;
+
+  // 两个缓冲都未被读取时丢弃较早的一帧
+  if (static_cast<int>(headless.pending.size()) == kReadbackBuffers)
+    headless.pending.pop_front();
+
+  const int index = headless.next;
+  headless.next = (headless.next + 1) % kReadbackBuffers;
+
+  // 绑定 PBO 时 glReadPixels 只排队复制，不等待 GPU
+  GLStateCache& gl = GLState();
+  const GLuint previous = gl.BoundFramebuffer();
+  gl.BindFramebuffer(headless.fbo);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, headless.pixelBuffers[index]);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, headless.width, headless.height, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  gl.BindFramebuffer(previous);
+  headless.pending.push_back(index);
+}
+
+void ShutdownHeadless()
+{
+  ContextState& ctx = Ctx();
+  if (!ctx.headless) return;
+  if (ctx.glewInitialized) ReleaseTarget(*ctx.headless);
+  DestroyContext(*ctx.headless);
+  ctx.headless.reset();
+}
+}  // namespace internal
+
+// ================ 无窗口渲染 ================
+bool Renderer::ResizeHeadless(int width, int height)
+{
+  VerifyRenderThread();
+  if (!internal::IsHeadless() || width <= 0 || height <= 0) return false;
+  HeadlessState& headless = State();
+  if (width == headless.width && height == headless.height) return true;
+
+  ReleaseTarget(headless);
+  const bool ok = internal::AllocateHeadlessTarget(width, height);
+  MarkAllDirty();
+  return ok;
+}
+
+bool Renderer::ReadPixels(void* pixels, size_t pitch)
+{
+  VerifyRenderThread();
+  if (!pixels || !internal::IsHeadless()) return false;
+  HeadlessState& headless = State();
+  if (headless.pending.empty()) return false;
+
+  // 行距小于一行像素会越过调用方缓冲末尾；拒绝时不消耗排队的帧
+  const size_t rowBytes = static_cast<size_t>(headless.width) * 4;
+  if (pitch == 0) pitch = rowBytes;
+  if (pitch < rowBytes) return false;
+
+  const int index = headless.pending.front();
+  headless.pending.pop_front();
+  const GLsizeiptr bytes =
+      static_cast<GLsizeiptr>(rowBytes) * headless.height;
+
+  // 仅在该帧的复制尚未完成时阻塞
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, headless.pixelBuffers[index]);
+  const uint8_t* src = static_cast<const uint8_t*>(
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT));
+  if (!src)
+  {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    std::cerr << "Failed to map readback buffer" << std::endl;
+    return false;
+  }
+
+  // GL 行序自下而上，翻转为图片常用的自上而下
+  uint8_t* dst = static_cast<uint8_t*>(pixels);
+  for (int y = 0; y < headless.height; ++y)
+  {
+    std::memcpy(dst + static_cast<size_t>(y) * pitch,
+                src + static_cast<size_t>(headless.height - 1 - y) * rowBytes,
+                rowBytes);
+  }
+  glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  return true;
+}
+
+int Renderer::PendingReadbacks()
+{
+  return internal::IsHeadless()
+             ? static_cast<int>(State().pending.size())
+             : 0;
+}
+
+}  // namespace gfx
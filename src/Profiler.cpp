@@ -0,0 +1,385 @@
+#include "libGfxInternal.h"
+
+#ifdef GFX_ENABLE_PROFILER
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <mutex>
+
+namespace gfx
+{
+namespace profiler
+{
+namespace detail
+{
+std::atomic<uint64_t> g_counters[static_cast<int>(Counter::Count)];
+}
+
+namespace
+{
+constexpr int kCounterCount = static_cast<int>(Counter::Count);
+constexpr const char* kCounterNames[kCounterCount] = {
+    "draw_calls", "texture_binds", "bytes_uploaded", "glyphs_rasterized",
+    "text_textures_created"};
+constexpr size_t kHistory = 120;              // 叠加层帧时间曲线长度
+constexpr uint32_t kMaxQueriesPerFrame = 64;  // 超出后的顶层区间只计 CPU
+constexpr size_t kMaxCaptureEvents = 1u << 20;
+constexpr size_t kNoEvent = ~size_t(0);
+
+using Clock = std::chrono::steady_clock;
+const Clock::time_point s_epoch = Clock::now();
+
+uint64_t NowNs()
+{
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                           s_epoch)
+          .count());
+}
+
+struct TraceEvent
+{
+  const char* name;
+  uint64_t beginNs;
+  uint64_t durationNs;
+  uint32_t tid;
+  int64_t gpuNs = -1;
+};
+
+struct CounterSample
+{
+  uint64_t ns;
+  double cpuMs;
+  uint64_t values[kCounterCount];
+};
+
+struct PendingQuery
+{
+  GLuint query;
+  uint64_t frame;
+  size_t event;         // 捕获中的事件下标，kNoEvent 表示未捕获
+  uint32_t generation;  // 重新开始捕获后旧下标失效
+};
+
+struct ProfilerState
+{
+  // 捕获数据可能来自录制线程的区间，受 mutex 保护
+  std::mutex mutex;
+  std::atomic<bool> capturing{false};
+  uint32_t generation = 0;
+  std::vector<TraceEvent> events;
+  std::vector<CounterSample> samples;
+  uint32_t renderTid = 0;
+
+  // 以下仅在渲染线程访问
+  uint64_t frame = 0;
+  uint64_t frameStartNs = 0;
+  uint32_t frameQueries = 0;
+  int timerQueries = -1;  // -1 未检测
+  std::vector<GLuint> freeQueries;
+  std::deque<PendingQuery> pending;
+  FrameProfile last;
+  double gpuMs = -1.0;
+  uint64_t gpuFrame = 0;
+  float history[kHistory] = {};
+  size_t historyPos = 0;
+};
+ProfilerState s_prof;
+
+std::atomic<uint32_t> s_nextTid{1};  // tid 0 留给 GPU 轨道
+thread_local uint32_t t_tid = 0;
+thread_local int t_depth = 0;
+
+uint32_t ThreadId()
+{
+  if (!t_tid) t_tid = s_nextTid.fetch_add(1, std::memory_order_relaxed);
+  return t_tid;
+}
+
+bool TimerQueriesSupported()
+{
+  if (s_prof.timerQueries < 0)
+    s_prof.timerQueries = GLEW_VERSION_3_3 || GLEW_ARB_timer_query ? 1 : 0;
+  return s_prof.timerQueries == 1;
+}
+
+GLuint AcquireQuery()
+{
+  if (s_prof.freeQueries.empty())
+  {
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    return query;
+  }
+  GLuint query = s_prof.freeQueries.back();
+  s_prof.freeQueries.pop_back();
+  return query;
+}
+
+// 查询按提交顺序完成：某帧最后一个查询可用时，该帧的全部结果都已就绪
+void ResolveQueries()
+{
+  while (!s_prof.pending.empty())
+  {
+    const uint64_t frame = s_prof.pending.front().frame;
+    size_t count = 0;
+    while (count < s_prof.pending.size() &&
+           s_prof.pending[count].frame == frame)
+      ++count;
+
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(s_prof.pending[count - 1].query,
+                       GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    uint64_t totalNs = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+      const PendingQuery& p = s_prof.pending.front();
+      GLuint64 ns = 0;
+      glGetQueryObjectui64v(p.query, GL_QUERY_RESULT, &ns);
+      totalNs += ns;
+      if (p.event != kNoEvent)
+      {
+        std::lock_guard<std::mutex> lock(s_prof.mutex);
+        if (p.generation == s_prof.generation && p.event < s_prof.events.size())
+          s_prof.events[p.event].gpuNs = static_cast<int64_t>(ns);
+      }
+      s_prof.freeQueries.push_back(p.query);
+      s_prof.pending.pop_front();
+    }
+    s_prof.gpuMs = totalNs / 1e6;
+    s_prof.gpuFrame = frame;
+  }
+}
+
+void WriteUs(std::ostream& out, uint64_t ns)
+{
+  char buf[32];
+  std::snprintf(buf, sizeof buf, "%.3f", ns / 1000.0);
+  out << buf;
+}
+}  // namespace
+
+// ================ Zone ================
+Zone::Zone(const char* name) : name_(name), beginNs_(NowNs())
+{
+  // 计时查询只在默认上下文中发起，由它的 Present 收集
+  if (t_depth++ != 0 || !internal::IsDefaultContext()) return;
+  if (s_prof.frameQueries >= kMaxQueriesPerFrame || !TimerQueriesSupported())
+    return;
+  query_ = AcquireQuery();
+  glBeginQuery(GL_TIME_ELAPSED, query_);
+  s_prof.frameQueries++;
+}
+
+Zone::~Zone()
+{
+  --t_depth;
+  const uint64_t endNs = NowNs();
+  if (query_) glEndQuery(GL_TIME_ELAPSED);
+
+  size_t event = kNoEvent;
+  uint32_t generation = 0;
+  if (s_prof.capturing.load(std::memory_order_relaxed))
+  {
+    std::lock_guard<std::mutex> lock(s_prof.mutex);
+    if (s_prof.capturing && s_prof.events.size() < kMaxCaptureEvents)
+    {
+      event = s_prof.events.size();
+      generation = s_prof.generation;
+      s_prof.events.push_back({name_, beginNs_, endNs - beginNs_, ThreadId()});
+    }
+  }
+  if (query_)
+    s_prof.pending.push_back({query_, s_prof.frame, event, generation});
+}
+
+// ================ 帧与捕获 ================
+FrameProfile GetLastFrame()
+{
+  return s_prof.last;
+}
+
+void StartCapture()
+{
+  std::lock_guard<std::mutex> lock(s_prof.mutex);
+  s_prof.events.clear();
+  s_prof.samples.clear();
+  s_prof.generation++;
+  s_prof.capturing = true;
+}
+
+void StopCapture()
+{
+  s_prof.capturing = false;
+}
+
+bool IsCapturing()
+{
+  return s_prof.capturing;
+}
+
+bool SaveChromeTrace(const std::string& path)
+{
+  std::ofstream out(path, std::ios::trunc);
+  if (!out)
+  {
+    std::cerr << "Failed to write trace: " << path << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(s_prof.mutex);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+         "\"args\":{\"name\":\"libGfx\"}},\n";
+  out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+         "\"args\":{\"name\":\"GPU\"}}";
+  if (s_prof.renderTid)
+  {
+    out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << s_prof.renderTid << ",\"args\":{\"name\":\"Render\"}}";
+  }
+
+  for (const TraceEvent& e : s_prof.events)
+  {
+    out << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"cpu\",\"ph\":\"X\","
+        << "\"pid\":1,\"tid\":" << e.tid << ",\"ts\":";
+    WriteUs(out, e.beginNs);
+    out << ",\"dur\":";
+    WriteUs(out, e.durationNs);
+    out << "}";
+    // GPU 区间没有独立的起始时间戳，对齐到对应 CPU 区间的开始
+    if (e.gpuNs >= 0)
+    {
+      out << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"gpu\",\"ph\":\"X\","
+          << "\"pid\":1,\"tid\":0,\"ts\":";
+      WriteUs(out, e.beginNs);
+      out << ",\"dur\":";
+      WriteUs(out, static_cast<uint64_t>(e.gpuNs));
+      out << "}";
+    }
+  }
+
+  for (const CounterSample& s : s_prof.samples)
+  {
+    out << ",\n{\"name\":\"frame\",\"ph\":\"C\",\"pid\":1,\"ts\":";
+    WriteUs(out, s.ns);
+    out << ",\"args\":{\"cpu_ms\":" << s.cpuMs << "}}";
+    out << ",\n{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"ts\":";
+    WriteUs(out, s.ns);
+    out << ",\"args\":{";
+    for (int i = 0; i < kCounterCount; ++i)
+      out << (i ? "," : "") << "\"" << kCounterNames[i] << "\":" << s.values[i];
+    out << "}}";
+  }
+  out << "\n]}\n";
+  return static_cast<bool>(out);
+}
+
+// ================ 叠加层 ================
+void DrawOverlay(Font* font, Point pos)
+{
+  if (!font) return;
+
+  const FrameProfile& p = s_prof.last;
+  const float lineHeight = static_cast<float>(font->size) * 1.25f;
+  const float graphHeight = 40.0f, barWidth = 2.0f, pad = 6.0f;
+  const float width = std::max(kHistory * barWidth, 300.0f) + 2 * pad;
+  Renderer::DrawRect(
+      Rect(pos.x, pos.y, width, lineHeight * 3 + graphHeight + 3 * pad),
+      Color(0, 0, 0, 170));
+
+  char line[128];
+  const auto drawLine = [&](int index) {
+    Renderer::DrawText(line,
+                       Point(pos.x + pad, pos.y + pad + lineHeight * (index + 1) -
+                                              lineHeight * 0.25f),
+                       font);
+  };
+  if (p.gpuMs >= 0.0)
+    std::snprintf(line, sizeof line, "frame %llu  cpu %.2f ms  gpu %.2f ms",
+                  static_cast<unsigned long long>(p.frame), p.cpuMs, p.gpuMs);
+  else
+    std::snprintf(line, sizeof line, "frame %llu  cpu %.2f ms",
+                  static_cast<unsigned long long>(p.frame), p.cpuMs);
+  drawLine(0);
+  std::snprintf(line, sizeof line, "draws %llu  binds %llu  upload %.1f KiB",
+                static_cast<unsigned long long>(p.Get(Counter::DrawCalls)),
+                static_cast<unsigned long long>(p.Get(Counter::TextureBinds)),
+                p.Get(Counter::BytesUploaded) / 1024.0);
+  drawLine(1);
+  std::snprintf(
+      line, sizeof line, "glyphs %llu  text textures %llu",
+      static_cast<unsigned long long>(p.Get(Counter::GlyphsRasterized)),
+      static_cast<unsigned long long>(p.Get(Counter::TextTexturesCreated)));
+  drawLine(2);
+
+  // 帧时间曲线：满高 33.3ms，超过 16.7ms 的帧标红
+  const float graphBottom = pos.y + 2 * pad + lineHeight * 3 + graphHeight;
+  for (size_t i = 0; i < kHistory; ++i)
+  {
+    const float ms = s_prof.history[(s_prof.historyPos + i) % kHistory];
+    const float h = std::min(ms / 33.3f, 1.0f) * graphHeight;
+    Renderer::DrawRect(
+        Rect(pos.x + pad + i * barWidth, graphBottom - h, barWidth - 0.5f, h),
+        ms > 16.7f ? Color(230, 70, 60) : Color(80, 200, 120));
+  }
+}
+}  // namespace profiler
+
+// ================ 帧结束 ================
+namespace internal
+{
+void ProfilerEndFrame()
+{
+  using namespace profiler;
+  const uint64_t now = NowNs();
+  FrameProfile& p = s_prof.last;
+  p.frame = s_prof.frame;
+  p.cpuMs = s_prof.frameStartNs ? (now - s_prof.frameStartNs) / 1e6 : 0.0;
+  for (int i = 0; i < kCounterCount; ++i)
+    p.counters[i] = detail::g_counters[i].exchange(0, std::memory_order_relaxed);
+
+  s_prof.history[s_prof.historyPos] = static_cast<float>(p.cpuMs);
+  s_prof.historyPos = (s_prof.historyPos + 1) % kHistory;
+
+  if (s_prof.capturing.load(std::memory_order_relaxed))
+  {
+    std::lock_guard<std::mutex> lock(s_prof.mutex);
+    s_prof.renderTid = ThreadId();
+    CounterSample sample{now, p.cpuMs, {}};
+    std::copy(p.counters, p.counters + kCounterCount, sample.values);
+    s_prof.samples.push_back(sample);
+  }
+
+  ResolveQueries();
+  p.gpuMs = s_prof.gpuMs;
+  p.gpuFrame = s_prof.gpuFrame;
+
+  s_prof.frameStartNs = now;
+  s_prof.frame++;
+  s_prof.frameQueries = 0;
+}
+
+void ProfilerShutdown()
+{
+  using namespace profiler;
+  for (const PendingQuery& p : s_prof.pending)
+    s_prof.freeQueries.push_back(p.query);
+  s_prof.pending.clear();
+  if (!s_prof.freeQueries.empty())
+  {
+    glDeleteQueries(static_cast<GLsizei>(s_prof.freeQueries.size()),
+                    s_prof.freeQueries.data());
+    s_prof.freeQueries.clear();
+  }
+  s_prof.timerQueries = -1;  // 下一个上下文重新检测
+  s_prof.frameStartNs = 0;
+}
+}  // namespace internal
+}  // namespace gfx
+
+#endif  // GFX_ENABLE_PROFILER
@@ -0,0 +1,328 @@
+#include "libGfxInternal.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace gfx
+{
+namespace
+{
+// 程序二进制缓存文件头；格式变化时递增 kBinaryVersion 使旧文件失效
+constexpr char kBinaryMagic[4] = {'G', 'F', 'X', 'P'};
+constexpr uint32_t kBinaryVersion = 1;
+
+struct BinaryHeader
+{
+  char magic[4];
+  uint32_t version;
+  uint32_t format;
+  uint32_t length;
+};
+
+// 多个上下文可在各自线程上同时创建程序
+struct ShaderCacheState
+{
+  std::mutex mutex;
+  bool configured = false;  // directory 已确定（显式设置或默认路径）
+  std::string directory;
+  int supported = -1;       // -1 未检测
+  ShaderCacheStats stats;
+};
+ShaderCacheState s_shaderCache;
+
+const std::string& CacheDirectory()
+{
+  if (!s_shaderCache.configured)
+  {
+    if (char* pref = SDL_GetPrefPath("libGfx", "shader-cache"))
+    {
+      s_shaderCache.directory = pref;
+      SDL_free(pref);
+    }
+    s_shaderCache.configured = true;
+  }
+  return s_shaderCache.directory;
+}
+
+bool BinaryCacheSupported()
+{
+  if (s_shaderCache.supported < 0)
+  {
+    // 部分驱动声明了扩展却不提供任何二进制格式
+    GLint formats = 0;
+    if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    s_shaderCache.supported = formats > 0 ? 1 : 0;
+  }
+  return s_shaderCache.supported == 1;
+}
+
+// 键 = 源码哈希 + 驱动标识；驱动升级后旧文件自然失配
+std::string CachePath(const char* vsSrc, const char* fsSrc)
+{
+  uint64_t h = internal::kFnvOffsetBasis;
+  for (const char* src : {vsSrc, fsSrc})
+  {
+    const uint64_t len = std::strlen(src);
+    h = internal::HashBytes(&len, sizeof len, h);
+    h = internal::HashBytes(src, len, h);
+  }
+  for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+  {
+    const char* str = reinterpret_cast<const char*>(glGetString(name));
+    if (str) h = internal::HashBytes(str, std::strlen(str), h);
+  }
+
+  char file[32];
+  std::snprintf(file, sizeof file, "%016llx.bin",
+                static_cast<unsigned long long>(h));
+  return (std::filesystem::path(CacheDirectory()) / file).string();
+}
+
+bool LoadBinary(GLuint program, const std::string& path)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+
+  BinaryHeader header;
+  if (!in.read(reinterpret_cast<char*>(&header), sizeof header) ||
+      std::memcmp(header.magic, kBinaryMagic, sizeof kBinaryMagic) != 0 ||
+      header.version != kBinaryVersion || header.length == 0)
+    return false;
+
+  std::vector<char> data(header.length);
+  if (!in.read(data.data(), header.length)) return false;
+  in.close();
+
+  glProgramBinary(program, header.format, data.data(),
+                  static_cast<GLsizei>(header.length));
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (!linked)
+  {
+    // 驱动拒绝（格式或版本变化），删除后回退到源码编译。不支持的格式会
+    // 留下 GL_INVALID_ENUM，清掉以免后续按 glGetError 检查的初始化误报失败
+    for (int i = 0; i < 8 && glGetError() != GL_NO_ERROR; ++i)
+    {
+    }
+    s_shaderCache.stats.rejected++;
+    std::remove(path.c_str());
+    return false;
+  }
+  return true;
+}
+
+void StoreBinary(GLuint program, const std::string& path)
+{
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) return;
+
+  std::vector<char> data(length);
+  GLenum format = 0;
+  GLsizei written = 0;
+  glGetProgramBinary(program, length, &written, &format, data.data());
+  if (written <= 0) return;
+
+  BinaryHeader header;
+  std::memcpy(header.magic, kBinaryMagic, sizeof kBinaryMagic);
+  header.version = kBinaryVersion;
+  header.format = format;
+  header.length = static_cast<uint32_t>(written);
+
+  // 先写临时文件再改名，并发启动的进程不会读到半个文件
+  std::error_code ec;
+  std::filesystem::create_directories(
+      std::filesystem::path(path).parent_path(), ec);
+  const std::string tmp = path + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) return;
+    out.write(reinterpret_cast<const char*>(&header), sizeof header);
+    out.write(data.data(), written);
+    if (!out) return;
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) == 0)
+    s_shaderCache.stats.stores++;
+  else
+    std::remove(tmp.c_str());
+}
+
+// 从源码编译并链接，错误写入日志
+GLuint CompileProgram(const char* vsSrc, const char* fsSrc, bool retrievable,
+                      bool* linked)
+{
+  GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vertexShader, 1, &vsSrc, NULL);
+  glCompileShader(vertexShader);
+
+  GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(fragmentShader, 1, &fsSrc, NULL);
+  glCompileShader(fragmentShader);
+
+  // 着色器错误检查
+  GLint success;
+  GLchar infoLog[512];
+  glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+  if (!success)
+  {
+    glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+    SDL_Log("Vertex shader compile error: %s", infoLog);
+  }
+  glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+  if (!success)
+  {
+    glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
+    SDL_Log("Fragment shader compile error: %s", infoLog);
+  }
+
+  GLuint program = glCreateProgram();
+  glAttachShader(program, vertexShader);
+  glAttachShader(program, fragmentShader);
+  if (retrievable)
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  glLinkProgram(program);
+
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success)
+  {
+    glGetProgramInfoLog(program, 512, NULL, infoLog);
+    SDL_Log("Shader program link error: %s", infoLog);
+  }
+  if (linked) *linked = success == GL_TRUE;
+
+  glDeleteShader(vertexShader);
+  glDeleteShader(fragmentShader);
+  return program;
+}
+}  // namespace
+
+namespace internal
+{
+GLuint BuildProgram(const char* vsSrc, const char* fsSrc, bool* linked)
+{
+  std::lock_guard<std::mutex> lock(s_shaderCache.mutex);
+  const bool useCache = !CacheDirectory().empty() && BinaryCacheSupported();
+  std::string path;
+  if (useCache)
+  {
+    path = CachePath(vsSrc, fsSrc);
+    GLuint program = glCreateProgram();
+    if (LoadBinary(program, path))
+    {
+      s_shaderCache.stats.hits++;
+      if (linked) *linked = true;
+      return program;
+    }
+    glDeleteProgram(program);
+  }
+
+  s_shaderCache.stats.misses++;
+  bool ok = false;
+  GLuint program = CompileProgram(vsSrc, fsSrc, useCache, &ok);
+  if (ok && useCache) StoreBinary(program, path);
+  if (linked) *linked = ok;
+  return program;
+}
+}  // namespace internal
+
+// ================ 着色器缓存 ================
+void Renderer::SetShaderCacheDirectory(const std::string& path)
+{
+  std::lock_guard<std::mutex> lock(s_shaderCache.mutex);
+  s_shaderCache.directory = path;
+  s_shaderCache.configured = true;
+}
+
+ShaderCacheStats Renderer::GetShaderCacheStats()
+{
+  std::lock_guard<std::mutex> lock(s_shaderCache.mutex);
+  return s_shaderCache.stats;
+}
+
+namespace advanced
+{
+// ================ Shader ================
+Shader* Shader::Create(const char* vsSrc, const char* fsSrc)
+{
+  VerifyRenderThread();
+  if (!vsSrc || !fsSrc) return nullptr;
+
+  bool linked = false;
+  GLuint program = internal::BuildProgram(vsSrc, fsSrc, &linked);
+  if (!linked)
+  {
+    glDeleteProgram(program);
+    return nullptr;
+  }
+  return new Shader(program);
+}
+
+Shader::~Shader()
+{
+  internal::GLState().OnProgramDeleted(program_);
+  glDeleteProgram(program_);
+}
+
+void Shader::Use()
+{
+  VerifyRenderThread();
+  // 批处理中的几何使用内置程序，切换前提交
+  internal::FlushBatch(FlushReason::Interleave);
+  internal::GLState().UseProgram(program_);
+}
+
+GLint Shader::GetUniformLocation(const char* name)
+{
+  auto it = locations_.find(name);
+  if (it != locations_.end()) return it->second;
+
+  GLint location = glGetUniformLocation(program_, name);
+  locations_.emplace(name, location);
+  return location;
+}
+
+void Shader::SetUniform(const char* name, float value)
+{
+  Use();
+  internal::GLState().Uniform1f(GetUniformLocation(name), value);
+}
+
+void Shader::SetUniform(const char* name, int value)
+{
+  Use();
+  internal::GLState().Uniform1i(GetUniformLocation(name), value);
+}
+
+void Shader::SetUniform(const char* name, const glm::vec2& value)
+{
+  Use();
+  internal::GLState().Uniform2f(GetUniformLocation(name), value.x, value.y);
+}
+
+void Shader::SetUniform(const char* name, const glm::vec4& value)
+{
+  Use();
+  internal::GLState().Uniform4f(GetUniformLocation(name), value.x, value.y,
+                                value.z, value.w);
+}
+
+void Shader::SetUniform(const char* name, const glm::mat4& value)
+{
+  Use();
+  internal::GLState().UniformMatrix4fv(GetUniformLocation(name),
+                                       glm::value_ptr(value));
+}
+
+void Shader::SetUniform(const char* name, const Color& color)
+{
+  Use();
+  internal::GLState().Uniform4f(GetUniformLocation(name), color.r / 255.0f,
+                                color.g / 255.0f, color.b / 255.0f,
+                                color.a / 255.0f);
+}
+}  // namespace advanced
+}  // namespace gfx
@@ -0,0 +1,44 @@
+#include "libGfxInternal.h"
+
+namespace gfx
+{
+namespace internal
+{
+
+void ShelfPacker::Reset(int width, int height)
+{
+  width_ = width;
+  height_ = height;
+  nextY_ = 0;
+  shelves_.clear();
+}
+
+bool ShelfPacker::Pack(int w, int h, int& x, int& y)
+{
+  if (w <= 0 || h <= 0 || w > width_ || h > height_) return false;
+
+  // 最佳适配：选择能容纳该高度且浪费最少的货架
+  Shelf* best = nullptr;
+  for (Shelf& shelf : shelves_)
+  {
+    if (shelf.height < h || shelf.cursorX + w > width_) continue;
+    if (!best || shelf.height < best->height) best = &shelf;
+  }
+
+  // 现有货架过高（浪费超过一半）时优先开新货架
+  if ((!best || best->height > h * 2) && nextY_ + h <= height_)
+  {
+    shelves_.push_back({nextY_, h, 0});
+    nextY_ += h;
+    best = &shelves_.back();
+  }
+  if (!best) return false;
+
+  x = best->cursorX;
+  y = best->y;
+  best->cursorX += w;
+  return true;
+}
+
+}  // namespace internal
+}  // namespace gfx
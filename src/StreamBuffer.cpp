@@ -0,0 +1,229 @@
+#include "libGfxInternal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+
+namespace gfx
+{
+namespace internal
+{
+
+bool StreamBuffer::Create(GLsizeiptr size)
+{
+  Destroy();
+
+  size_ = size;
+  regionSize_ = size / kRegions;
+  if (GLEW_ARB_buffer_storage)
+    mode_ = StreamMode::Persistent;
+  else if (GLEW_ARB_map_buffer_range && GLEW_ARB_sync)
+    mode_ = StreamMode::Unsynchronized;
+  else
+    mode_ = StreamMode::Orphan;
+
+  // 映射与上传都经由 COPY_WRITE 目标，不影响 VAO 的缓冲绑定
+  glGenBuffers(1, &buffer_);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+  if (mode_ == StreamMode::Persistent)
+  {
+    const GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size_, nullptr, flags);
+    persistent_ = static_cast<uint8_t*>(
+        glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size_, flags));
+    if (!persistent_)
+    {
+      // 驱动拒绝常驻映射时退回非同步映射（需重建不可变存储）
+      glDeleteBuffers(1, &buffer_);
+      glGenBuffers(1, &buffer_);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+      mode_ = GLEW_ARB_sync ? StreamMode::Unsynchronized : StreamMode::Orphan;
+    }
+  }
+  if (mode_ != StreamMode::Persistent)
+  {
+    glBufferData(GL_COPY_WRITE_BUFFER, size_, nullptr, GL_STREAM_DRAW);
+  }
+  if (mode_ == StreamMode::Orphan) staging_.resize(regionSize_);
+
+  frame_ = StreamStats{};
+  frame_.mode = mode_;
+  lastFrame_ = frame_;
+
+  GLenum err = glGetError();
+  if (err != GL_NO_ERROR)
+  {
+    std::cerr << "Failed to create stream buffer: " << err << std::endl;
+    Destroy();
+    return false;
+  }
+  return true;
+}
+
+void StreamBuffer::Destroy()
+{
+  for (GLsync& fence : fences_)
+  {
+    if (fence) glDeleteSync(fence);
+    fence = nullptr;
+  }
+  if (buffer_)
+  {
+    if (persistent_)
+    {
+      glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+      glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    glDeleteBuffers(1, &buffer_);
+  }
+  buffer_ = 0;
+  persistent_ = nullptr;
+  staging_.clear();
+  head_ = 0;
+  currentRegion_ = 0;
+  std::fill(std::begin(written_), std::end(written_), false);
+  std::fill(std::begin(retired_), std::end(retired_), false);
+}
+
+void StreamBuffer::WaitRegion(size_t region)
+{
+  GLsync& fence = fences_[region];
+  if (!fence) return;
+
+  GLenum result = glClientWaitSync(fence, 0, 0);
+  if (result == GL_TIMEOUT_EXPIRED)
+  {
+    // GPU 仍在读取该区域：阻塞等待并计入停顿
+    const auto start = std::chrono::steady_clock::now();
+    do
+    {
+      result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                1000000000ull);
+    } while (result == GL_TIMEOUT_EXPIRED);
+    frame_.fenceWaits++;
+    frame_.fenceWaitMs += std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+  }
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+StreamBuffer::Region StreamBuffer::Map(GLsizeiptr bytes, GLsizeiptr alignment)
+{
+  GLsizeiptr start = (head_ + alignment - 1) / alignment * alignment;
+  const bool wrap = start + bytes > size_;
+  if (wrap)
+  {
+    start = 0;
+    frame_.wraps++;
+  }
+
+  const size_t first = static_cast<size_t>(start / regionSize_);
+  const size_t last = static_cast<size_t>((start + bytes - 1) / regionSize_);
+
+  if (mode_ == StreamMode::Orphan)
+  {
+    // 回绕时孤立整块存储，驱动为仍在使用的旧存储另行分配；
+    // 一次绘制的全部数据须来自同一次 Map，否则前半部分会留在旧存储中
+    if (wrap)
+    {
+      glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+      glBufferData(GL_COPY_WRITE_BUFFER, size_, nullptr, GL_STREAM_DRAW);
+    }
+  }
+  else if (wrap || last != currentRegion_)
+  {
+    // 离开的区域可能仍被即将发出的绘制读取，栅栏推迟到 FenceWritten
+    for (size_t r = 0; r < kRegions; ++r)
+    {
+      if (!written_[r]) continue;
+      retired_[r] = true;
+      written_[r] = false;
+    }
+    // 进入新区域前等待 GPU 读完；当前区域中 head 之后的部分从未被读取
+    for (size_t r = first; r <= last; ++r)
+    {
+      if (r == currentRegion_ && !wrap) continue;
+      WaitRegion(r);
+    }
+    currentRegion_ = last;
+  }
+  for (size_t r = first; r <= last; ++r) written_[r] = true;
+
+  pendingOffset_ = start;
+  pendingBytes_ = bytes;
+  head_ = start + bytes;
+  frame_.bytesStreamed += bytes;
+  frame_.allocations++;
+
+  switch (mode_)
+  {
+    case StreamMode::Persistent:
+      return {persistent_ + start, start};
+    case StreamMode::Unsynchronized:
+    {
+      glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+      void* ptr = glMapBufferRange(
+          GL_COPY_WRITE_BUFFER, start, bytes,
+          GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+              GL_MAP_INVALIDATE_RANGE_BIT);
+      return {ptr, start};
+    }
+    case StreamMode::Orphan:
+    default:
+      if (static_cast<GLsizeiptr>(staging_.size()) < bytes)
+        staging_.resize(bytes);
+      return {staging_.data(), start};
+  }
+}
+
+void StreamBuffer::Commit()
+{
+  if (mode_ == StreamMode::Unsynchronized)
+  {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  }
+  else if (mode_ == StreamMode::Orphan)
+  {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, pendingOffset_, pendingBytes_,
+                    staging_.data());
+  }
+  pendingBytes_ = 0;
+}
+
+GLintptr StreamBuffer::Upload(const void* data, GLsizeiptr bytes,
+                              GLsizeiptr alignment)
+{
+  Region region = Map(bytes, alignment);
+  if (region.data) std::memcpy(region.data, data, bytes);
+  Commit();
+  GFX_PROFILE_COUNT(BytesUploaded, bytes);
+  return region.offset;
+}
+
+void StreamBuffer::FenceWritten()
+{
+  // 只为已离开的区域加栅栏，同一区域内的连续绘制不产生额外的 GL 调用
+  for (size_t r = 0; r < kRegions; ++r)
+  {
+    if (!retired_[r]) continue;
+    if (fences_[r]) glDeleteSync(fences_[r]);
+    fences_[r] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    retired_[r] = false;
+  }
+}
+
+void StreamBuffer::EndFrame()
+{
+  lastFrame_ = frame_;
+  frame_ = StreamStats{};
+  frame_.mode = mode_;
+}
+
+}  // namespace internal
+}  // namespace gfx
@@ -0,0 +1,332 @@
+#include "../include/libGfx.h"
+#include "libGfxInternal.h"
+
+#include <algorithm>
+#include <cmath>
+
+// 粗线 CPU 三角化：线段四边形 + 连接 + 端帽，全部写入批处理缓冲
+namespace gfx
+{
+namespace
+{
+constexpr float kPi = 3.14159265358979f;
+
+// 结构数组（SoA）形式的临时缓冲，逐线段计算在独立的循环里完成，便于编译器向量化
+struct StrokeScratch
+{
+  std::vector<float> x, y;    // 去重后的顶点
+  std::vector<float> ux, uy;  // 线段单位方向
+  std::vector<float> nx, ny;  // 线段单位法线
+};
+// 每个渲染线程一份：不同线程上的上下文可同时描线
+thread_local StrokeScratch t_scratch;
+
+// 线条的保守包围盒（点集外扩 pad）与签名，供脏区跟踪使用
+bool StrokeDamageTest(const Point* points, size_t count, float pad,
+                      Color color, const StrokeStyle& style, bool closed)
+{
+  if (internal::CurrentDamageMode() == DamageMode::Off) return true;
+
+  float x0 = points[0].x, y0 = points[0].y, x1 = x0, y1 = y0;
+  for (size_t i = 1; i < count; ++i)
+  {
+    x0 = std::min(x0, points[i].x);
+    y0 = std::min(y0, points[i].y);
+    x1 = std::max(x1, points[i].x);
+    y1 = std::max(y1, points[i].y);
+  }
+  const Rect bounds(x0 - pad, y0 - pad, x1 - x0 + 2.0f * pad,
+                    y1 - y0 + 2.0f * pad);
+  return internal::DamageTest(bounds, [&] {
+    const uint32_t rgba = color;
+    uint64_t h = internal::HashBytes(points, count * sizeof(Point));
+    h = internal::HashBytes(&rgba, sizeof rgba, h);
+    h = internal::HashBytes(&style, sizeof style, h);
+    return internal::HashBytes(&closed, sizeof closed, h);
+  });
+}
+
+// 根据 x/y 计算 segs 条线段的方向与法线；第 i 条线段从点 i 指向点 (i+1)%n
+void ComputeSegmentFrames(size_t n, size_t segs)
+{
+  StrokeScratch& sc = t_scratch;
+  sc.ux.resize(segs);
+  sc.uy.resize(segs);
+  sc.nx.resize(segs);
+  sc.ny.resize(segs);
+
+  const float* x = sc.x.data();
+  const float* y = sc.y.data();
+  float* ux = sc.ux.data();
+  float* uy = sc.uy.data();
+  for (size_t i = 0; i + 1 < n; ++i)
+  {
+    ux[i] = x[i + 1] - x[i];
+    uy[i] = y[i + 1] - y[i];
+  }
+  if (segs == n)  // 闭合折线的最后一段
+  {
+    ux[n - 1] = x[0] - x[n - 1];
+    uy[n - 1] = y[0] - y[n - 1];
+  }
+
+  float* nx = sc.nx.data();
+  float* ny = sc.ny.data();
+  for (size_t i = 0; i < segs; ++i)
+  {
+    const float inv = 1.0f / std::sqrt(ux[i] * ux[i] + uy[i] * uy[i]);
+    ux[i] *= inv;
+    uy[i] *= inv;
+    nx[i] = -uy[i];
+    ny[i] = ux[i];
+  }
+}
+
+class StrokeWriter
+{
+ public:
+  explicit StrokeWriter(Color color) : color_(color) {}
+
+  void Quad(glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d)
+  {
+    internal::BatchAllocation alloc =
+        internal::AllocateBatch(internal::WhiteTexture(), 4, 6);
+    const glm::vec2 p[4] = {a, b, c, d};
+    for (int i = 0; i < 4; ++i) alloc.vertices[i] = Vertex(p[i]);
+    const GLushort base = alloc.base;
+    const GLushort idx[6] = {base, GLushort(base + 1), GLushort(base + 2),
+                             GLushort(base + 2), GLushort(base + 3), base};
+    std::copy(idx, idx + 6, alloc.indices);
+    internal::Ctx().batch.frameStats.quads++;
+  }
+
+  // 以 center 为圆心的扇形，rim 为外沿点
+  void Fan(glm::vec2 center, const glm::vec2* rim, size_t count)
+  {
+    if (count < 2) return;
+    internal::BatchAllocation alloc = internal::AllocateBatch(
+        internal::WhiteTexture(), count + 1, (count - 1) * 3);
+    alloc.vertices[0] = Vertex(center);
+    for (size_t i = 0; i < count; ++i) alloc.vertices[i + 1] = Vertex(rim[i]);
+    for (size_t i = 0; i + 1 < count; ++i)
+    {
+      alloc.indices[i * 3 + 0] = alloc.base;
+      alloc.indices[i * 3 + 1] = GLushort(alloc.base + i + 1);
+      alloc.indices[i * 3 + 2] = GLushort(alloc.base + i + 2);
+    }
+    // 统计以四边形计，两个三角形折合一个
+    internal::Ctx().batch.frameStats.quads +=
+        static_cast<uint32_t>(count / 2);
+  }
+
+  // 从方向 from 沿 sweep 弧度旋转的圆弧扇形
+  void Arc(glm::vec2 center, float radius, float from, float sweep)
+  {
+    const int steps =
+        std::max(1, static_cast<int>(std::ceil(std::fabs(sweep) / (kPi / 8))));
+    glm::vec2 rim[18];
+    for (int i = 0; i <= steps; ++i)
+    {
+      const float a = from + sweep * i / steps;
+      rim[i] = glm::vec2(center.x + std::cos(a) * radius,
+                         center.y + std::sin(a) * radius);
+    }
+    Fan(center, rim, steps + 1);
+  }
+
+ private:
+  internal::BatchVertex Vertex(glm::vec2 p) const
+  {
+    return {p.x, p.y, 0.0f, 0.0f, color_.r, color_.g, color_.b, color_.a};
+  }
+
+  Color color_;
+};
+
+void EmitJoin(StrokeWriter& out, const StrokeStyle& style, float hw,
+              glm::vec2 p, size_t a, size_t b)
+{
+  const StrokeScratch& sc = t_scratch;
+  const float cross = sc.ux[a] * sc.uy[b] - sc.uy[a] * sc.ux[b];
+  const float dot = sc.ux[a] * sc.ux[b] + sc.uy[a] * sc.uy[b];
+  if (std::fabs(cross) < 1e-4f && dot > 0.0f) return;  // 共线
+
+  // 向 +n 侧转弯时外侧是 -n 侧
+  const float side = cross > 0.0f ? -1.0f : 1.0f;
+  const glm::vec2 na(sc.nx[a] * side, sc.ny[a] * side);
+  const glm::vec2 nb(sc.nx[b] * side, sc.ny[b] * side);
+  const glm::vec2 outerA = p + na * hw;
+  const glm::vec2 outerB = p + nb * hw;
+
+  if (style.join == LineJoin::Round)
+  {
+    const float from = std::atan2(na.y, na.x);
+    float sweep = std::atan2(nb.y, nb.x) - from;
+    if (sweep > kPi) sweep -= 2 * kPi;
+    if (sweep < -kPi) sweep += 2 * kPi;
+    out.Arc(p, hw, from, sweep);
+    return;
+  }
+
+  if (style.join == LineJoin::Miter)
+  {
+    glm::vec2 m = na + nb;
+    const float mlen = std::sqrt(m.x * m.x + m.y * m.y);
+    if (mlen > 1e-4f)
+    {
+      m = m * (1.0f / mlen);
+      const float cosHalf = m.x * na.x + m.y * na.y;
+      const float ratio = 1.0f / cosHalf;  // 斜接长度 / 半线宽
+      if (ratio <= style.miterLimit)
+      {
+        out.Quad(p, outerA, p + m * (hw * ratio), outerB);
+        return;
+      }
+    }
+  }
+
+  // Bevel（也是超出斜接限制时的回退）
+  const glm::vec2 rim[2] = {outerA, outerB};
+  out.Fan(p, rim, 2);
+}
+
+void EmitCap(StrokeWriter& out, LineCap cap, float hw, glm::vec2 p,
+             size_t seg, bool start)
+{
+  if (cap != LineCap::Round) return;  // Square 已在线段延长中处理
+  const StrokeScratch& sc = t_scratch;
+  // 起点的半圆朝 -u 方向，终点朝 +u 方向
+  const float n = std::atan2(sc.ny[seg], sc.nx[seg]);
+  out.Arc(p, hw, n, start ? kPi : -kPi);
+}
+
+void SubmitIfImmediate()
+{
+  if (!Renderer::IsBatching()) internal::FlushBatch(FlushReason::Interleave);
+}
+}  // namespace
+
+// ================ 折线绘制 ================
+void Renderer::DrawPolyline(const Point* points, size_t count, Color color,
+                            const StrokeStyle& style, bool closed)
+{
+  if (!points || count < 2) return;
+  // 斜接最长伸出 miterLimit 倍半线宽，方形端帽的角约 1.42 倍
+  const float pad =
+      std::max(style.width, 1.0f) * 0.5f * std::max(style.miterLimit, 1.5f);
+  if (!StrokeDamageTest(points, count, pad, color, style, closed)) return;
+
+  // 拷贝为 SoA 并去除连续重复点（零长度线段没有方向）
+  StrokeScratch& sc = t_scratch;
+  sc.x.clear();
+  sc.y.clear();
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (!sc.x.empty() && sc.x.back() == points[i].x &&
+        sc.y.back() == points[i].y)
+      continue;
+    sc.x.push_back(points[i].x);
+    sc.y.push_back(points[i].y);
+  }
+  size_t n = sc.x.size();
+  if (closed && n > 2 && sc.x[0] == sc.x[n - 1] && sc.y[0] == sc.y[n - 1])
+  {
+    --n;
+  }
+  if (n < 2) return;
+  if (n < 3) closed = false;
+
+  const size_t segs = closed ? n : n - 1;
+  ComputeSegmentFrames(n, segs);
+
+  const float hw = std::max(style.width, 1.0f) * 0.5f;
+  const LineCap cap = closed ? LineCap::Butt : style.cap;
+  StrokeWriter out(color);
+
+  for (size_t i = 0; i < segs; ++i)
+  {
+    const size_t j = (i + 1) % n;
+    glm::vec2 p0(sc.x[i], sc.y[i]);
+    glm::vec2 p1(sc.x[j], sc.y[j]);
+    const glm::vec2 u(sc.ux[i], sc.uy[i]);
+    const glm::vec2 o(sc.nx[i] * hw, sc.ny[i] * hw);
+
+    if (cap == LineCap::Square)
+    {
+      if (i == 0) p0 = p0 - u * hw;
+      if (i == segs - 1) p1 = p1 + u * hw;
+    }
+    out.Quad(p0 + o, p1 + o, p1 - o, p0 - o);
+
+    // 当前线段终点处与下一线段的连接
+    if (i + 1 < segs || closed)
+    {
+      EmitJoin(out, style, hw, glm::vec2(sc.x[j], sc.y[j]), i, (i + 1) % segs);
+    }
+  }
+
+  if (!closed)
+  {
+    EmitCap(out, cap, hw, glm::vec2(sc.x[0], sc.y[0]), 0, true);
+    EmitCap(out, cap, hw, glm::vec2(sc.x[n - 1], sc.y[n - 1]), segs - 1, false);
+  }
+  SubmitIfImmediate();
+}
+
+void Renderer::DrawLines(const Point* points, size_t count, Color color,
+                         float width)
+{
+  if (!points || count < 2) return;
+  StrokeStyle style;
+  style.width = width;
+  if (!StrokeDamageTest(points, count, std::max(width, 1.0f) * 0.5f, color,
+                        style, false))
+    return;
+
+  // 每对点一条独立线段：x/y 存起点，ux/uy 存终点
+  StrokeScratch& sc = t_scratch;
+  const size_t segs = count / 2;
+  sc.x.resize(segs);
+  sc.y.resize(segs);
+  sc.ux.resize(segs);
+  sc.uy.resize(segs);
+  sc.nx.resize(segs);
+  sc.ny.resize(segs);
+  for (size_t i = 0; i < segs; ++i)
+  {
+    sc.x[i] = points[i * 2].x;
+    sc.y[i] = points[i * 2].y;
+    sc.ux[i] = points[i * 2 + 1].x;
+    sc.uy[i] = points[i * 2 + 1].y;
+  }
+
+  // 法线乘以半线宽；零长度线段得到 0 偏移，退化为不可见的四边形
+  const float hw = std::max(width, 1.0f) * 0.5f;
+  for (size_t i = 0; i < segs; ++i)
+  {
+    const float dx = sc.ux[i] - sc.x[i];
+    const float dy = sc.uy[i] - sc.y[i];
+    const float len2 = dx * dx + dy * dy;
+    const float inv = len2 > 0.0f ? hw / std::sqrt(len2) : 0.0f;
+    sc.nx[i] = -dy * inv;
+    sc.ny[i] = dx * inv;
+  }
+
+  StrokeWriter out(color);
+  for (size_t i = 0; i < segs; ++i)
+  {
+    const glm::vec2 p0(sc.x[i], sc.y[i]);
+    const glm::vec2 p1(sc.ux[i], sc.uy[i]);
+    const glm::vec2 o(sc.nx[i], sc.ny[i]);
+    out.Quad(p0 + o, p1 + o, p1 - o, p0 - o);
+  }
+  SubmitIfImmediate();
+}
+
+void Renderer::DrawLine(Point p1, Point p2, Color color, float width)
+{
+  const Point points[2] = {p1, p2};
+  DrawLines(points, 2, color, width);
+}
+
+}  // namespace gfx
@@ -0,0 +1,128 @@
+#include "libGfxInternal.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace gfx
+{
+
+TextureAtlas::TextureAtlas(int pageSize, int padding)
+    : pageSize_(std::max(pageSize, 1)), padding_(std::max(padding, 0))
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+  for (Page& page : pages_) internal::DeleteTexture(page.texture);
+}
+
+const SubTexture* TextureAtlas::Add(const std::string& path)
+{
+  if (const SubTexture* existing = Find(path)) return existing;
+
+  SDL_Surface* surface = internal::DecodeImage(path);
+  if (!surface) return nullptr;
+  const SubTexture* sub = Add(path, surface->pixels, surface->w, surface->h);
+  SDL_FreeSurface(surface);
+  return sub;
+}
+
+const SubTexture* TextureAtlas::Add(const std::string& name, const void* rgba,
+                                    int width, int height)
+{
+  VerifyRenderThread();
+  if (const SubTexture* existing = Find(name)) return existing;
+  if (!rgba || width <= 0 || height <= 0) return nullptr;
+
+  const int p = padding_;
+  const int pw = width + 2 * p, ph = height + 2 * p;
+  GLuint texture = 0;
+  int x = 0, y = 0, pageW = 0, pageH = 0;
+  if (!Place(pw, ph, texture, x, y, pageW, pageH)) return nullptr;
+
+  // 四周外扩 padding 个像素的边缘颜色，线性过滤时不会混入相邻图片
+  const uint8_t* src = static_cast<const uint8_t*>(rgba);
+  scratch_.resize(static_cast<size_t>(pw) * ph * 4);
+  for (int row = 0; row < ph; ++row)
+  {
+    const int sy = std::clamp(row - p, 0, height - 1);
+    const uint8_t* srcRow = src + static_cast<size_t>(sy) * width * 4;
+    uint8_t* dst = &scratch_[static_cast<size_t>(row) * pw * 4];
+    for (int col = 0; col < p; ++col)
+    {
+      std::memcpy(dst + col * 4, srcRow, 4);
+      std::memcpy(dst + (p + width + col) * 4, srcRow + (width - 1) * 4, 4);
+    }
+    std::memcpy(dst + p * 4, srcRow, static_cast<size_t>(width) * 4);
+  }
+
+  internal::GLState().BindTexture(0, texture);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, pw, ph, GL_RGBA, GL_UNSIGNED_BYTE,
+                  scratch_.data());
+  GFX_PROFILE_COUNT(BytesUploaded, scratch_.size());
+
+  SubTexture sub;
+  sub.texture = texture;
+  sub.uv = Rect(static_cast<float>(x + p) / pageW,
+                static_cast<float>(y + p) / pageH,
+                static_cast<float>(width) / pageW,
+                static_cast<float>(height) / pageH);
+  sub.width = width;
+  sub.height = height;
+  return &entries_.emplace(name, sub).first->second;
+}
+
+const SubTexture* TextureAtlas::Find(const std::string& name) const
+{
+  auto it = entries_.find(name);
+  return it != entries_.end() ? &it->second : nullptr;
+}
+
+bool TextureAtlas::Place(int w, int h, GLuint& texture, int& x, int& y,
+                         int& pageW, int& pageH)
+{
+  const bool oversized = w > pageSize_ || h > pageSize_;
+  if (!oversized)
+  {
+    for (Page& page : pages_)
+    {
+      if (page.packer->Pack(w, h, x, y))
+      {
+        texture = page.texture;
+        pageW = page.packer->Width();
+        pageH = page.packer->Height();
+        return true;
+      }
+    }
+  }
+
+  // 新页；超出页尺寸的图片独占一页
+  Page page;
+  pageW = oversized ? w : pageSize_;
+  pageH = oversized ? h : pageSize_;
+  page.packer = std::make_unique<internal::ShelfPacker>(pageW, pageH);
+  if (!page.packer->Pack(w, h, x, y)) return false;
+
+  glGenTextures(1, &page.texture);
+  internal::GLState().BindTexture(0, page.texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, pageW, pageH, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+
+  GLenum err = glGetError();
+  if (err != GL_NO_ERROR)
+  {
+    std::cerr << "Failed to create atlas page: " << err << std::endl;
+    internal::DeleteTexture(page.texture);
+    return false;
+  }
+
+  texture = page.texture;
+  pages_.push_back(std::move(page));
+  return true;
+}
+
+}  // namespace gfx
@@ -0,0 +1,646 @@
+#include "libGfxInternal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+
+namespace gfx
+{
+namespace
+{
+// 一个异步加载请求；工作线程只读写 surface/cancelled，其余字段归渲染线程
+struct LoadJob
+{
+  std::string path;
+  Texture* texture = nullptr;
+  std::atomic<bool> cancelled{false};
+  SDL_Surface* surface = nullptr;  // 解码结果，失败为 nullptr
+};
+using LoadJobPtr = std::shared_ptr<LoadJob>;
+
+/// 固定数量的解码线程：pending_ 待解码，decoded_ 等待渲染线程上传
+class DecodePool
+{
+ public:
+  ~DecodePool() { Stop(); }
+
+  bool Running() const { return !workers_.empty(); }
+
+  void Start(int threads)
+  {
+    stopping_ = false;
+    for (int i = 0; i < threads; ++i)
+      workers_.emplace_back([this] { WorkerMain(); });
+  }
+
+  // 等待正在解码的任务结束；未开始和未上传的任务全部丢弃
+  void Stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) worker.join();
+    workers_.clear();
+
+    for (const LoadJobPtr& job : decoded_)
+      if (job->surface) SDL_FreeSurface(job->surface);
+    pending_.clear();
+    decoded_.clear();
+  }
+
+  void Enqueue(LoadJobPtr job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_.push_back(std::move(job));
+    }
+    wake_.notify_one();
+  }
+
+  // 取出最早解码完成的任务；maxBytes 以内才取出（0 表示不限）
+  LoadJobPtr PopDecoded(size_t maxBytes)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (decoded_.empty()) return nullptr;
+    const SDL_Surface* s = decoded_.front()->surface;
+    if (maxBytes && s && static_cast<size_t>(s->pitch) * s->h > maxBytes)
+      return nullptr;
+    LoadJobPtr job = std::move(decoded_.front());
+    decoded_.pop_front();
+    return job;
+  }
+
+  void Counts(uint32_t& decoding, uint32_t& awaitingUpload)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    decoding = static_cast<uint32_t>(pending_.size()) + busy_;
+    awaitingUpload = static_cast<uint32_t>(decoded_.size());
+  }
+
+ private:
+  void WorkerMain()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+      wake_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+      if (stopping_) return;
+
+      LoadJobPtr job = std::move(pending_.front());
+      pending_.pop_front();
+      ++busy_;
+      lock.unlock();
+
+      // 排队期间已被释放的纹理不必再解码
+      if (!job->cancelled.load(std::memory_order_relaxed))
+        job->surface = internal::DecodeImage(job->path);
+
+      lock.lock();
+      --busy_;
+      if (stopping_)
+      {
+        if (job->surface) SDL_FreeSurface(job->surface);
+        return;
+      }
+      decoded_.push_back(std::move(job));
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<LoadJobPtr> pending_;
+  std::deque<LoadJobPtr> decoded_;
+  uint32_t busy_ = 0;
+  bool stopping_ = false;
+};
+
+// ---------------- 默认上下文的异步加载状态 ----------------
+AsyncLoadConfig s_config;
+DecodePool s_pool;
+// 任一线程上的 ~Texture 都可能取消加载，与渲染线程的上传发布互斥
+std::mutex s_inFlightMutex;
+std::unordered_map<const Texture*, LoadJobPtr> s_inFlight;
+GLuint s_placeholder = 0;          // 当前占位纹理
+GLuint s_builtinPlaceholder = 0;   // 内置 1x1 半透明灰
+GLuint s_pixelBuffer = 0;          // 上传暂存 PBO
+AsyncLoadStats s_stats;
+
+// ---------------- 路径缓存 ----------------
+// paths 指向 byPath 中的键（unordered_map 节点地址稳定），供按纹理反查
+struct TextureCache
+{
+  std::unordered_map<std::string, Texture*> byPath;
+  std::unordered_map<const Texture*, const std::string*> paths;
+  bool retainUnused = false;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+};
+}  // namespace
+
+// 共享组内的上下文可能在不同线程上同时查找、插入和释放
+struct internal::ShareGroup
+{
+  std::mutex mutex;
+  TextureCache cache;
+  int contexts = 0;
+  // 组内任一上下文删除纹理时递增，各上下文据此丢弃纹理绑定缓存
+  std::atomic<uint32_t> textureDeletions{0};
+};
+
+namespace
+{
+using internal::ShareGroup;
+ShareGroup s_detachedGroup;  // 没有当前上下文时
+
+ShareGroup& Group()
+{
+  ShareGroup* group = internal::Ctx().shareGroup.get();
+  return group ? *group : s_detachedGroup;
+}
+
+// "./a/../b.png" 与 "b.png" 共用一个条目
+std::string CacheKey(const std::string& path)
+{
+  return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+Texture* FindCached(ShareGroup& group, const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(group.mutex);
+  TextureCache& cache = group.cache;
+  auto it = cache.byPath.find(key);
+  if (it == cache.byPath.end())
+  {
+    ++cache.misses;
+    return nullptr;
+  }
+  ++cache.hits;
+  ++internal::RecordOf(it->second).refs;
+  return it->second;
+}
+
+// 其它线程已抢先加载同一路径时丢弃 tex，返回已有的条目
+Texture* InsertCached(ShareGroup& group, const std::string& key,
+                      Texture* tex)
+{
+  Texture* existing;
+  {
+    std::lock_guard<std::mutex> lock(group.mutex);
+    auto [it, inserted] = group.cache.byPath.emplace(key, tex);
+    if (inserted)
+    {
+      internal::RecordOf(tex).refs = 1;
+      group.cache.paths[tex] = &it->first;
+      return tex;
+    }
+    existing = it->second;
+    ++internal::RecordOf(existing).refs;
+  }
+  delete tex;
+  return existing;
+}
+
+// 需持有 group.mutex
+void EraseCached(TextureCache& cache, const Texture* tex)
+{
+  auto it = cache.paths.find(tex);
+  if (it == cache.paths.end()) return;
+  // 键引用的正是要删除的节点，按迭代器删除
+  cache.byPath.erase(cache.byPath.find(*it->second));
+  cache.paths.erase(it);
+}
+
+GLuint Placeholder()
+{
+  if (!s_builtinPlaceholder)
+  {
+    const uint8_t gray[4] = {128, 128, 128, 128};
+    s_builtinPlaceholder = internal::UploadTextureRGBA(gray, 1, 1);
+  }
+  return s_placeholder ? s_placeholder : s_builtinPlaceholder;
+}
+
+int DefaultWorkerCount()
+{
+  const int hw = static_cast<int>(std::thread::hardware_concurrency());
+  return std::clamp(hw - 1, 1, 4);
+}
+}  // namespace
+
+namespace internal
+{
+SDL_Surface* DecodeImage(const std::string& path)
+{
+  SDL_Surface* surface = IMG_Load(path.c_str());
+  if (!surface)
+  {
+    std::cerr << "Failed to load image: " << path << " - " << IMG_GetError()
+              << std::endl;
+    return nullptr;
+  }
+
+  SDL_Surface* converted =
+      SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+  SDL_FreeSurface(surface);
+  if (!converted)
+  {
+    std::cerr << "Failed to convert image: " << path << std::endl;
+    return nullptr;
+  }
+  return converted;
+}
+
+GLuint UploadTextureRGBA(const void* pixels, int width, int height,
+                         GLuint pixelBuffer)
+{
+  GLuint textureID;
+  glGenTextures(1, &textureID);
+  GLState().BindTexture(0, textureID);
+
+  // 设置纹理参数
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  const GLsizeiptr bytes = static_cast<GLsizeiptr>(width) * height * 4;
+  const void* source = pixels;
+  if (pixelBuffer)
+  {
+    // 孤立旧存储后写入 PBO，glTexImage2D 从缓冲读取时无需同步拷贝
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                 GL_MAP_WRITE_BIT |
+                                     GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dst)
+    {
+      std::memcpy(dst, pixels, static_cast<size_t>(bytes));
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      source = nullptr;  // 偏移 0
+    }
+    else
+    {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      pixelBuffer = 0;
+    }
+  }
+
+  // 上传纹理数据（MIN_FILTER 为 LINEAR，不需要 mipmap）
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, source);
+  // PBO 保持绑定会让其它纹理上传误读缓冲
+  if (pixelBuffer) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  GFX_PROFILE_COUNT(BytesUploaded, bytes);
+
+  // 检查错误
+  GLenum err = glGetError();
+  if (err != GL_NO_ERROR)
+  {
+    std::cerr << "Failed to upload texture: " << err << std::endl;
+    DeleteTexture(textureID);
+    return 0;
+  }
+  return textureID;
+}
+
+TextureRecord& RecordOf(Texture* tex)
+{
+  TextureRecord*& record = TextureAccess::Record(*tex);
+  if (!record)
+  {
+    record = new TextureRecord();
+    record->id.store(tex->id, std::memory_order_relaxed);
+  }
+  return *record;
+}
+
+TextureState StateOf(const Texture* tex)
+{
+  const TextureRecord* record = TextureAccess::Record(*tex);
+  return record ? record->state.load(std::memory_order_acquire)
+                : TextureState::Ready;
+}
+
+void FenceTextureUpload(Texture* tex, GLuint textureID)
+{
+  // 其它上下文等待前栅栏必须已提交，否则 glWaitSync 可能永不返回
+  TextureRecord& record = RecordOf(tex);
+  record.uploader = Ctx().serial;
+  record.fence.store(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+                     std::memory_order_release);
+  glFlush();
+  record.id.store(textureID, std::memory_order_release);
+  tex->id = textureID;
+}
+
+GLuint AcquireTexture(const Texture* tex)
+{
+  const TextureRecord* record = TextureAccess::Record(*tex);
+  if (!record) return tex->id;
+  // 先取 id：看到上传后的名字时，栅栏（先于 id 写入）必然可见
+  const GLuint id = record->id.load(std::memory_order_acquire);
+  GLsync fence = record->fence.load(std::memory_order_acquire);
+  if (fence && record->uploader != Ctx().serial)
+    glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);  // 已发出信号时只是空操作
+  return id;
+}
+
+bool CancelTextureLoad(const Texture* tex)
+{
+  std::lock_guard<std::mutex> lock(s_inFlightMutex);
+  auto it = s_inFlight.find(tex);
+  if (it != s_inFlight.end())
+  {
+    // 工作线程仍可能持有任务，只做标记；表面在出队时释放
+    it->second->cancelled.store(true, std::memory_order_relaxed);
+    it->second->texture = nullptr;
+    s_inFlight.erase(it);
+  }
+  // 上传在同一互斥量下发布，此时状态已是最终值
+  return StateOf(tex) == TextureState::Ready;
+}
+
+void ForgetCachedTexture(const Texture* tex)
+{
+  ShareGroup& group = Group();
+  std::lock_guard<std::mutex> lock(group.mutex);
+  EraseCached(group.cache, tex);
+}
+
+void JoinShareGroup(ContextState& ctx, const ContextState* shareWith)
+{
+  ctx.shareGroup = shareWith && shareWith->shareGroup
+                       ? shareWith->shareGroup
+                       : std::make_shared<ShareGroup>();
+  ctx.glState.ShareTextureNames(&ctx.shareGroup->textureDeletions);
+  std::lock_guard<std::mutex> lock(ctx.shareGroup->mutex);
+  ++ctx.shareGroup->contexts;
+}
+
+void LeaveShareGroup(ContextState& ctx)
+{
+  std::shared_ptr<ShareGroup> group = std::move(ctx.shareGroup);
+  if (!group) return;
+  ctx.glState.ShareTextureNames(nullptr);
+
+  // 最后一个上下文：先摘下整张表，~Texture 回调 ForgetCachedTexture 时
+  // 不会改动正在遍历的容器
+  TextureCache cache;
+  {
+    std::lock_guard<std::mutex> lock(group->mutex);
+    if (--group->contexts > 0) return;
+    cache = std::move(group->cache);
+    group->cache = TextureCache{};
+  }
+  for (auto& [path, tex] : cache.byPath) delete tex;
+}
+
+void ShutdownTextureLoader()
+{
+  s_pool.Stop();
+  {
+    std::lock_guard<std::mutex> lock(s_inFlightMutex);
+    for (auto& [tex, job] : s_inFlight)
+      internal::RecordOf(job->texture)
+          .state.store(TextureState::Failed, std::memory_order_release);
+    s_inFlight.clear();
+  }
+
+  if (s_pixelBuffer) glDeleteBuffers(1, &s_pixelBuffer);
+  if (s_builtinPlaceholder) DeleteTexture(s_builtinPlaceholder);
+  s_pixelBuffer = 0;
+  s_builtinPlaceholder = 0;
+  s_placeholder = 0;
+  s_stats = AsyncLoadStats{};
+}
+}  // namespace internal
+
+Texture* Renderer::LoadTexture(const std::string& path)
+{
+  GFX_PROFILE_ZONE("Renderer::LoadTexture");
+  ShareGroup& group = Group();
+  const std::string key = CacheKey(path);
+  if (Texture* cached = FindCached(group, key)) return cached;
+  if (Texture* packed = internal::LoadFromMountedPacks(key))
+    return InsertCached(group, key, packed);
+
+  SDL_Surface* converted = internal::DecodeImage(path);
+  if (!converted) return nullptr;
+
+  const int width = converted->w;
+  const int height = converted->h;
+  GLuint textureID =
+      internal::UploadTextureRGBA(converted->pixels, width, height);
+  SDL_FreeSurface(converted);
+  if (!textureID) return nullptr;
+
+  Texture* tex = new Texture{textureID, width, height};
+  internal::FenceTextureUpload(tex, textureID);
+  return InsertCached(group, key, tex);
+}
+
+void Renderer::ReleaseTexture(Texture* tex)
+{
+  if (!tex) return;
+
+  ShareGroup& group = Group();
+  {
+    std::lock_guard<std::mutex> lock(group.mutex);
+    // 缓存纹理：还有其它引用，或保留策略下留给 TrimTextureCache
+    internal::TextureRecord& record = internal::RecordOf(tex);
+    if (record.refs > 1 || (record.refs == 1 && group.cache.retainUnused))
+    {
+      --record.refs;
+      return;
+    }
+    // 先移出缓存，其它线程不会再取到将要删除的纹理
+    EraseCached(group.cache, tex);
+  }
+  delete tex;  // 释放 GL 纹理
+}
+
+// ================ 纹理缓存 ================
+void Renderer::SetTextureCacheRetain(bool retain)
+{
+  {
+    ShareGroup& group = Group();
+    std::lock_guard<std::mutex> lock(group.mutex);
+    group.cache.retainUnused = retain;
+  }
+  if (!retain) TrimTextureCache();
+}
+
+size_t Renderer::TrimTextureCache()
+{
+  std::vector<Texture*> unused;
+  {
+    ShareGroup& group = Group();
+    std::lock_guard<std::mutex> lock(group.mutex);
+    for (const auto& [path, tex] : group.cache.byPath)
+      if (internal::RecordOf(tex).refs == 0) unused.push_back(tex);
+    for (Texture* tex : unused) EraseCached(group.cache, tex);
+  }
+  for (Texture* tex : unused) delete tex;
+  return unused.size();
+}
+
+TextureCacheStats Renderer::GetTextureCacheStats()
+{
+  ShareGroup& group = Group();
+  std::lock_guard<std::mutex> lock(group.mutex);
+  TextureCacheStats stats;
+  stats.hits = group.cache.hits;
+  stats.misses = group.cache.misses;
+  stats.entries = static_cast<uint32_t>(group.cache.byPath.size());
+  for (const auto& [path, tex] : group.cache.byPath)
+  {
+    if (internal::RecordOf(tex).refs == 0) ++stats.unreferenced;
+    // 尺寸在加载完成、以 release 发布状态之前写入
+    if (internal::StateOf(tex) == TextureState::Ready)
+      stats.bytes += static_cast<size_t>(tex->width) * tex->height * 4;
+  }
+  return stats;
+}
+
+// ================ 异步纹理加载 ================
+Texture* Renderer::LoadTextureAsync(const std::string& path)
+{
+  VerifyRenderThread();
+  // 解码线程与上传队列属于默认上下文，其它上下文同步加载
+  if (!internal::IsDefaultContext()) return LoadTexture(path);
+
+  ShareGroup& group = Group();
+  const std::string key = CacheKey(path);
+  if (Texture* cached = FindCached(group, key)) return cached;
+  // 资源包中的纹理无需解码，同步上传即可
+  if (Texture* packed = internal::LoadFromMountedPacks(key))
+    return InsertCached(group, key, packed);
+
+  if (!s_pool.Running())
+  {
+    s_pool.Start(s_config.workerThreads > 0 ? s_config.workerThreads
+                                            : DefaultWorkerCount());
+  }
+
+  Texture* tex = new Texture{Placeholder(), 0, 0};
+  internal::RecordOf(tex).state.store(TextureState::Loading,
+                                      std::memory_order_relaxed);
+  // 先登记再发布到缓存：其它线程取到后立即释放也能找到并取消
+  auto job = std::make_shared<LoadJob>();
+  job->path = path;
+  job->texture = tex;
+  {
+    std::lock_guard<std::mutex> lock(s_inFlightMutex);
+    s_inFlight.emplace(tex, job);
+  }
+  Texture* cached = InsertCached(group, key, tex);
+  if (cached != tex) return cached;  // 共享组内其它线程抢先加载；tex 已取消
+  s_pool.Enqueue(std::move(job));
+  return tex;
+}
+
+bool Renderer::IsTextureReady(const Texture* tex)
+{
+  return tex && internal::StateOf(tex) == TextureState::Ready;
+}
+
+void Renderer::ConfigureAsyncLoading(const AsyncLoadConfig& config)
+{
+  s_config = config;
+}
+
+void Renderer::SetPlaceholderTexture(const Texture* placeholder)
+{
+  s_placeholder = placeholder ? placeholder->id : 0;
+}
+
+void Renderer::ProcessTextureUploads()
+{
+  VerifyRenderThread();
+  if (!internal::IsDefaultContext()) return;
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point start = Clock::now();
+  const auto elapsedMs = [&start] {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+  };
+
+  s_stats.uploadedLastFrame = 0;
+  s_stats.bytesUploadedLastFrame = 0;
+  if (s_config.usePixelBuffer && !s_pixelBuffer && s_pool.Running())
+    glGenBuffers(1, &s_pixelBuffer);
+
+  size_t uploaded = 0;
+  for (;;)
+  {
+    // 每帧至少上传一张，超出预算的大图也能最终完成
+    const size_t budget = s_config.uploadBytesPerFrame;
+    size_t remaining = 0;
+    if (uploaded > 0)
+    {
+      if (uploaded >= budget || elapsedMs() >= s_config.uploadMsPerFrame)
+        break;
+      remaining = budget - uploaded;
+    }
+    LoadJobPtr job = s_pool.PopDecoded(remaining);
+    if (!job) break;
+
+    SDL_Surface* surface = job->surface;
+    GLuint textureID = 0;
+    if (surface && !job->cancelled.load(std::memory_order_relaxed))
+    {
+      textureID = internal::UploadTextureRGBA(
+          surface->pixels, surface->w, surface->h,
+          s_config.usePixelBuffer ? s_pixelBuffer : 0);
+      uploaded += static_cast<size_t>(surface->pitch) * surface->h;
+    }
+
+    {
+      // 其它线程上的 ~Texture 在同一互斥量下取消，持锁期间 tex 不会被释放
+      std::lock_guard<std::mutex> lock(s_inFlightMutex);
+      Texture* tex = job->texture;
+      if (tex)
+      {
+        s_inFlight.erase(tex);
+        internal::TextureRecord& record = internal::RecordOf(tex);
+        if (textureID)
+        {
+          // 栅栏、id 之后才以 release 发布状态
+          tex->width = surface->w;
+          tex->height = surface->h;
+          internal::FenceTextureUpload(tex, textureID);
+          record.state.store(TextureState::Ready, std::memory_order_release);
+          ++s_stats.uploadedLastFrame;
+        }
+        else
+        {
+          // 继续显示占位纹理
+          record.state.store(TextureState::Failed, std::memory_order_release);
+          ++s_stats.failed;
+        }
+        textureID = 0;
+      }
+    }
+    if (textureID) internal::DeleteTexture(textureID);  // 上传期间被取消
+    if (surface) SDL_FreeSurface(surface);
+  }
+
+  s_stats.bytesUploadedLastFrame = uploaded;
+  s_stats.uploadMsLastFrame = elapsedMs();
+}
+
+AsyncLoadStats Renderer::GetAsyncLoadStats()
+{
+  AsyncLoadStats stats = s_stats;
+  s_pool.Counts(stats.decoding, stats.awaitingUpload);
+  return stats;
+}
+}  // namespace gfx
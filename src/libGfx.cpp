@@ -1,35 +1,55 @@
 #include "../include/libGfx.h"
+#include "libGfxInternal.h"
 
 #include <GL/glew.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
 #include <stdexcept>
 #include <unordered_map>
 #include <vector>
-glm::mat4 s_projection;
-GLuint lineVAO = 0, lineVBO = 0;
 namespace gfx
 {
 
-// ================ 内部全局状态 ================
+static_assert(sizeof(RectInstance) == 20 && sizeof(SpriteInstance) == 36,
+              "instance structs are uploaded verbatim and must stay packed");
+static_assert(std::is_standard_layout<SpriteInstance>::value,
+              "instance structs need offsetof");
+
+// ================ 上下文 ================
 namespace
 {
-SDL_Window* s_window = nullptr;
-SDL_GLContext s_glContext = nullptr;
-std::thread::id s_renderThreadId;
-bool s_glewInitialized = false;
+// 各线程的当前上下文；没有时指向不含 GL 对象的占位状态
+internal::ContextState s_detached;
+thread_local internal::ContextState* t_current = nullptr;
+
+RenderContext* s_default = nullptr;  // Renderer::Init 创建的默认上下文
+std::mutex s_bindMutex;              // 保护各上下文的 thread 字段
+std::mutex s_createMutex;            // glewInit 写全局函数指针，创建串行化
+std::atomic<uint64_t> s_contextSerial{0};
 
-// 字体/纹理缓存
-std::unordered_map<std::string, Texture*> s_textureCache;
-std::unordered_map<FontKey, Font*> s_fontCache;
+constexpr GLsizeiptr kStreamBufferSize = 16 << 20;
 
-GLuint quadVAO = 0, quadVBO = 0;
-GLuint shaderProgram = 0;
+using internal::BatchVertex;
+using internal::kMaxBatchVertices;
 }  // namespace
 
+internal::ContextState& internal::Ctx()
+{
+  return t_current ? *t_current : s_detached;
+}
+
+bool internal::IsDefaultContext()
+{
+  return t_current && s_default && t_current->owner == s_default;
+}
+
 // ================ 辅助函数 ================
 bool IsRenderThread()
 {
-  return std::this_thread::get_id() == s_renderThreadId;
+  return t_current != nullptr;
 }
 
 void VerifyRenderThread()
@@ -40,31 +60,396 @@ void VerifyRenderThread()
   }
 }
 
-// ================ 初始化实现 ================
-bool Renderer::Init(SDL_Window* window)
+internal::GLStateCache& internal::GLState()
+{
+  return Ctx().glState;
+}
+
+internal::StreamBuffer& internal::Stream()
+{
+  return Ctx().stream;
+}
+
+SDL_Window* internal::Window()
 {
-  if (s_window) return true;  // 避免重复初始化
+  return Ctx().window;
+}
 
-  s_window = window;
-  s_renderThreadId = std::this_thread::get_id();
+void internal::TargetSize(int* width, int* height)
+{
+  if (HeadlessSize(width, height)) return;
+  SDL_GetWindowSize(Ctx().window, width, height);
+}
+
+void internal::DrawableSize(int* width, int* height)
+{
+  if (HeadlessSize(width, height)) return;
+  SDL_GL_GetDrawableSize(Ctx().window, width, height);
+}
+
+void internal::DeleteTexture(GLuint texture)
+{
+  if (!texture) return;
+  Renderer::Flush();  // 待提交的批次可能仍引用该纹理
+  Ctx().glState.OnTextureDeleted(texture);
+  glDeleteTextures(1, &texture);
+}
+
+// 选定主着色器，并同步投影矩阵与混合状态（未变化时由缓存跳过）
+static void UseMainProgram(internal::ContextState& ctx)
+{
+  ctx.glState.UseProgram(ctx.shaderProgram);
+  ctx.glState.UniformMatrix4fv(ctx.uniforms.projection,
+                               glm::value_ptr(ctx.projection));
+  ctx.glState.SetBlendMode(ctx.blendMode);
+}
+
+// ================ 批处理 ================
+void internal::FlushBatch(FlushReason reason)
+{
+  internal::ContextState& ctx = Ctx();
+  if (ctx.batch.indices.empty()) return;
+  GFX_PROFILE_ZONE("FlushBatch");
+
+  ApplyDamageScissor();
+  ctx.glState.UseProgram(ctx.batchProgram);
+  ctx.glState.UniformMatrix4fv(ctx.batchProjLoc,
+                               glm::value_ptr(ctx.projection));
+  ctx.glState.SetBlendMode(ctx.blendMode);
+  ctx.glState.BindTexture(0, ctx.batch.texture);
+
+  // 顶点与索引取自同一次分配：顶点按步长对齐，以 baseVertex 定位，
+  // VAO 无需重新指定；索引紧随其后
+  static_assert(sizeof(BatchVertex) % sizeof(GLuint) == 0,
+                "indices following the vertices must stay aligned");
+  const GLsizeiptr vbytes = ctx.batch.vertices.size() * sizeof(BatchVertex);
+  const GLsizeiptr ibytes = ctx.batch.indices.size() * sizeof(GLushort);
+  internal::StreamBuffer::Region region =
+      ctx.stream.Map(vbytes + ibytes, sizeof(BatchVertex));
+  if (region.data)
+  {
+    uint8_t* dst = static_cast<uint8_t*>(region.data);
+    std::memcpy(dst, ctx.batch.vertices.data(), vbytes);
+    std::memcpy(dst + vbytes, ctx.batch.indices.data(), ibytes);
+  }
+  ctx.stream.Commit();
+  GFX_PROFILE_COUNT(BytesUploaded, vbytes + ibytes);
+  const GLintptr voffset = region.offset;
+  const GLintptr ioffset = region.offset + vbytes;
+
+  ctx.glState.BindVertexArray(ctx.batchVAO);
+  glDrawElementsBaseVertex(
+      GL_TRIANGLES, static_cast<GLsizei>(ctx.batch.indices.size()),
+      GL_UNSIGNED_SHORT, reinterpret_cast<void*>(ioffset),
+      static_cast<GLint>(voffset / sizeof(BatchVertex)));
+  ctx.stream.FenceWritten();
+  ctx.batch.frameStats.drawCalls++;
+  GFX_PROFILE_COUNT(DrawCalls, 1);
+
+  BatchStats& stats = ctx.batch.frameStats;
+  stats.flushes++;
+  stats.flushReasons[static_cast<int>(reason)]++;
+  stats.vertices += static_cast<uint32_t>(ctx.batch.vertices.size());
+
+  ctx.batch.vertices.clear();
+  ctx.batch.indices.clear();
+}
+
+internal::BatchAllocation internal::AllocateBatch(GLuint texture,
+                                                  size_t vertexCount,
+                                                  size_t indexCount)
+{
+  internal::ContextState& ctx = Ctx();
+  if (texture != ctx.batch.texture && !ctx.batch.indices.empty())
+    FlushBatch(FlushReason::TextureChange);
+  if (ctx.batch.vertices.size() + vertexCount > kMaxBatchVertices)
+    FlushBatch(FlushReason::BufferFull);
+  ctx.batch.texture = texture;
+
+  const size_t v = ctx.batch.vertices.size(), i = ctx.batch.indices.size();
+  ctx.batch.vertices.resize(v + vertexCount);
+  ctx.batch.indices.resize(i + indexCount);
+  return {&ctx.batch.vertices[v], &ctx.batch.indices[i],
+          static_cast<GLushort>(v)};
+}
+
+GLuint internal::WhiteTexture()
+{
+  return Ctx().whiteTexture;
+}
+
+// 追加一个已变换到屏幕坐标的四边形（角点顺序：左上、右上、右下、左下）
+static void PushQuadCorners(GLuint tex, const glm::vec2 corners[4], float u0,
+                            float v0, float u1, float v1, Color color)
+{
+  internal::BatchAllocation alloc = internal::AllocateBatch(tex, 4, 6);
+
+  const float us[4] = {u0, u1, u1, u0};
+  const float vs[4] = {v0, v0, v1, v1};
+  for (int i = 0; i < 4; ++i)
+  {
+    alloc.vertices[i] = {corners[i].x, corners[i].y, us[i], vs[i],
+                         color.r, color.g, color.b, color.a};
+  }
+  const GLushort base = alloc.base;
+  const GLushort quad[6] = {base, GLushort(base + 1), GLushort(base + 2),
+                            GLushort(base + 2), GLushort(base + 3), base};
+  std::copy(quad, quad + 6, alloc.indices);
+  internal::Ctx().batch.frameStats.quads++;
+}
+
+// 计算矩形（可绕中心旋转，角度制）的四个屏幕坐标角点
+static void QuadCorners(const Rect& dest, float rotation, glm::vec2 out[4])
+{
+  out[0] = glm::vec2(dest.x, dest.y);
+  out[1] = glm::vec2(dest.x + dest.w, dest.y);
+  out[2] = glm::vec2(dest.x + dest.w, dest.y + dest.h);
+  out[3] = glm::vec2(dest.x, dest.y + dest.h);
+  if (rotation == 0.0f) return;
+
+  const float rad = glm::radians(rotation);
+  const float c = std::cos(rad), s = std::sin(rad);
+  const float cx = dest.x + dest.w * 0.5f, cy = dest.y + dest.h * 0.5f;
+  for (int i = 0; i < 4; ++i)
+  {
+    const float dx = out[i].x - cx, dy = out[i].y - cy;
+    out[i] = glm::vec2(cx + dx * c - dy * s, cy + dx * s + dy * c);
+  }
+}
+
+// 旋转矩形的保守包围盒（以半对角线为半径）
+static Rect RotatedBounds(const Rect& dest, float rotation)
+{
+  if (rotation == 0.0f) return dest;
+  const float r = 0.5f * std::sqrt(dest.w * dest.w + dest.h * dest.h);
+  const float cx = dest.x + dest.w * 0.5f, cy = dest.y + dest.h * 0.5f;
+  return Rect(cx - r, cy - r, 2.0f * r, 2.0f * r);
+}
+
+void internal::PushQuad(GLuint texture, const Rect& dest, float u0, float v0,
+                        float u1, float v1, Color color, float rotation)
+{
+  glm::vec2 corners[4];
+  QuadCorners(dest, rotation, corners);
+  PushQuadCorners(texture, corners, u0, v0, u1, v1, color);
+}
+
+// ================ 渲染上下文 ================
+RenderContext::RenderContext() : state_(new internal::ContextState())
+{
+  state_->owner = this;
+  state_->serial = ++s_contextSerial;
+}
+
+// 新建的 GL 上下文：绑定到调用线程、加入共享组并建立渲染状态
+static bool SetUpContext(RenderContext* context, internal::ContextState& ctx,
+                         const internal::ContextState* shareWith, int width,
+                         int height)
+{
+  if (!RenderContext::MakeCurrent(context)) return false;
+  internal::JoinShareGroup(ctx, shareWith);
+  if (!internal::InitRendererState(width, height)) return false;
+  return !ctx.headless || internal::AllocateHeadlessTarget(width, height);
+}
+
+RenderContext* RenderContext::Create(SDL_Window* window,
+                                     RenderContext* shareWith)
+{
+  std::lock_guard<std::mutex> lock(s_createMutex);
+  RenderContext* previous = Current();
+  // SDL 与创建时的当前上下文共享对象
+  if (shareWith && !MakeCurrent(shareWith)) return nullptr;
+
+  std::unique_ptr<RenderContext> context(new RenderContext());
+  internal::ContextState& ctx = *context->state_;
+  ctx.window = window;
 
   // 创建OpenGL上下文
-  s_glContext = SDL_GL_CreateContext(window);
-  if (!s_glContext)
+  SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, shareWith ? 1 : 0);
+  ctx.glContext = SDL_GL_CreateContext(window);
+  SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+  if (!ctx.glContext)
   {
     SDL_Log("Failed to create GL context: %s", SDL_GetError());
+    MakeCurrent(previous);
+    return nullptr;
+  }
+
+  int width, height;
+  SDL_GetWindowSize(window, &width, &height);
+  if (!SetUpContext(context.get(), ctx,
+                    shareWith ? shareWith->state_.get() : nullptr, width,
+                    height))
+    context.reset();
+  MakeCurrent(previous);
+  return context.release();
+}
+
+RenderContext* RenderContext::CreateHeadless(int width, int height,
+                                             RenderContext* shareWith)
+{
+  if (width <= 0 || height <= 0)
+  {
+    std::cerr << "Invalid headless target size: " << width << "x" << height
+              << std::endl;
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(s_createMutex);
+  RenderContext* previous = Current();
+  std::unique_ptr<RenderContext> context(new RenderContext());
+  internal::ContextState& ctx = *context->state_;
+  const internal::ContextState* share =
+      shareWith ? shareWith->state_.get() : nullptr;
+  if (!internal::CreateHeadlessContext(ctx, share))
+  {
+    MakeCurrent(previous);
+    return nullptr;
+  }
+
+  if (!SetUpContext(context.get(), ctx, share, width, height))
+    context.reset();
+  MakeCurrent(previous);
+  return context.release();
+}
+
+RenderContext::~RenderContext()
+{
+  internal::ContextState& ctx = *state_;
+  if (!ctx.glContext && !ctx.headless) return;  // GL 上下文未能创建
+  RenderContext* previous = Current();
+  if (previous == this) previous = nullptr;
+  if (!MakeCurrent(this))
+  {
+    SDL_Log("RenderContext destroyed while current on another thread; "
+            "its GL objects are leaked");
+    return;
+  }
+  if (s_default == this) s_default = nullptr;
+
+  ctx.batch = internal::BatchState{};  // 丢弃未提交的批次
+  if (ctx.glewInitialized)
+  {
+    // 清理资源缓存（仍在组内，删除的纹理名会通知其它上下文）
+    for (auto& [key, font] : ctx.fontCache)
+    {
+      delete font;
+    }
+    ctx.fontCache.clear();
+    internal::LeaveShareGroup(ctx);  // 组内最后一个上下文释放缓存的纹理
+
+    // 删除VBO和VAO
+    glDeleteVertexArrays(1, &ctx.quadVAO);
+    glDeleteBuffers(1, &ctx.quadVBO);
+    glDeleteVertexArrays(1, &ctx.batchVAO);
+    ctx.stream.Destroy();
+    glDeleteProgram(ctx.shaderProgram);
+    glDeleteProgram(ctx.batchProgram);
+    glDeleteVertexArrays(1, &ctx.instanceVAO);
+    glDeleteProgram(ctx.instanceProgram);
+    glDeleteTextures(1, &ctx.whiteTexture);
+  }
+  internal::ShutdownHeadless();  // 无窗口模式的 FBO/PBO 与上下文
+
+  // 销毁OpenGL上下文
+  if (ctx.glContext)
+  {
+    SDL_GL_MakeCurrent(ctx.window, nullptr);
+    SDL_GL_DeleteContext(ctx.glContext);
+  }
+  {
+    std::lock_guard<std::mutex> lock(s_bindMutex);
+    ctx.thread = std::thread::id();
+    t_current = nullptr;
+  }
+  MakeCurrent(previous);
+}
+
+bool RenderContext::MakeCurrent(RenderContext* context)
+{
+  internal::ContextState* next = context ? context->state_.get() : nullptr;
+  if (next == t_current) return true;
+
+  std::lock_guard<std::mutex> lock(s_bindMutex);
+  if (next && next->thread != std::thread::id())
+  {
+    SDL_Log("RenderContext is current on another thread");
     return false;
   }
 
+  bool bound;
+  if (next)
+  {
+    bound = next->headless
+                ? internal::MakeHeadlessCurrent(*next->headless, true)
+                : SDL_GL_MakeCurrent(next->window, next->glContext) == 0;
+  }
+  else
+  {
+    bound = t_current->headless
+                ? internal::MakeHeadlessCurrent(*t_current->headless, false)
+                : SDL_GL_MakeCurrent(t_current->window, nullptr) == 0;
+  }
+  if (!bound)
+  {
+    SDL_Log("Failed to make GL context current: %s", SDL_GetError());
+    return false;
+  }
+
+  if (t_current) t_current->thread = std::thread::id();
+  if (next) next->thread = std::this_thread::get_id();
+  t_current = next;
+  return true;
+}
+
+RenderContext* RenderContext::Current()
+{
+  return t_current ? t_current->owner : nullptr;
+}
+
+SDL_Window* RenderContext::GetWindow() const
+{
+  return state_->window;
+}
+
+// ================ 初始化实现 ================
+// 默认上下文：静态 Renderer 接口在初始化线程上作用于它
+static bool InitDefaultContext(RenderContext* context)
+{
+  if (!context) return false;
+  s_default = context;
+  return RenderContext::MakeCurrent(context);
+}
+
+bool Renderer::Init(SDL_Window* window)
+{
+  if (s_default) return true;  // 避免重复初始化
+  return InitDefaultContext(RenderContext::Create(window));
+}
+
+bool Renderer::InitHeadless(int width, int height)
+{
+  if (s_default) return true;  // 避免重复初始化
+  return InitDefaultContext(RenderContext::CreateHeadless(width, height));
+}
+
+bool internal::InitRendererState(int width, int height)
+{
+  internal::ContextState& ctx = Ctx();
+
   // 初始化GLEW
   glewExperimental = GL_TRUE;
   GLenum err = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+  // EGL 上下文没有 GLX display，但 GL 入口已经加载
+  if (err == GLEW_ERROR_NO_GLX_DISPLAY && IsHeadless()) err = GLEW_OK;
+#endif
   if (err != GLEW_OK)
   {
     SDL_Log("GLEW init failed: %s", glewGetErrorString(err));
     return false;
   }
-  s_glewInitialized = true;
+  ctx.glewInitialized = true;
 
   // OpenGL基础配置
   glEnable(GL_BLEND);
@@ -90,20 +475,11 @@ bool Renderer::Init(SDL_Window* window)
       0.0f, 1.0f, 0.0f, 0.0f, 1.0f   // 左上
   };
 
-  // 线段 VAO/VBO
-  glGenVertexArrays(1, &lineVAO);
-  glGenBuffers(1, &lineVBO);
-  glBindVertexArray(lineVAO);
-  glBindBuffer(GL_ARRAY_BUFFER, lineVBO);
-  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-  glEnableVertexAttribArray(0);
-  glBindVertexArray(0);
-
   // 四边形 VAO/VBO
-  glGenVertexArrays(1, &quadVAO);
-  glGenBuffers(1, &quadVBO);
-  glBindVertexArray(quadVAO);
-  glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+  glGenVertexArrays(1, &ctx.quadVAO);
+  glGenBuffers(1, &ctx.quadVBO);
+  glBindVertexArray(ctx.quadVAO);
+  glBindBuffer(GL_ARRAY_BUFFER, ctx.quadVBO);
   glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
@@ -161,58 +537,133 @@ void main() {
 
     )";
 
-  // 编译顶点着色器
-  GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-  glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-  glCompileShader(vertexShader);
-
-  // 编译片段着色器
-  GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-  glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-  glCompileShader(fragmentShader);
-
-  // 着色器错误检查
-  GLint success;
-  GLchar infoLog[512];
-  glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-  if (!success)
-  {
-    glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-    SDL_Log("Vertex shader compile error: %s", infoLog);
-  }
-  glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-  if (!success)
-  {
-    glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-    SDL_Log("Fragment shader compile error: %s", infoLog);
-  }
+  ctx.shaderProgram =
+      internal::BuildProgram(vertexShaderSource, fragmentShaderSource);
 
-  // 链接程序
-  shaderProgram = glCreateProgram();
-  glAttachShader(shaderProgram, vertexShader);
-  glAttachShader(shaderProgram, fragmentShader);
-  glLinkProgram(shaderProgram);
+  // ---------------- 批处理着色器与缓冲 ----------------
+  const char* batchVertexSource = R"(
+    #version 330 core
+    layout(location = 0) in vec2 position;
+    layout(location = 1) in vec2 texCoord;
+    layout(location = 2) in vec4 color;
 
-  // 检查链接错误
-  glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-  if (!success)
-  {
-    glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-    SDL_Log("Shader program link error: %s", infoLog);
-  }
+    uniform mat4 projection;
+    out vec2 TexCoord;
+    out vec4 Color;
+    void main() {
+        gl_Position = projection * vec4(position, 0.0, 1.0);
+        TexCoord = texCoord;
+        Color = color;
+    })";
+
+  const char* batchFragmentSource = R"(
+    #version 330 core
+    in vec2 TexCoord;
+    in vec4 Color;
+    out vec4 fragColor;
+    uniform sampler2D texture1;
+
+    void main() {
+        vec4 texColor = texture(texture1, TexCoord);
+        if (texColor.a < 0.1) {
+            discard;
+        }
+        fragColor = texColor * Color;
+    })";
+
+  ctx.batchProgram =
+      internal::BuildProgram(batchVertexSource, batchFragmentSource);
+  ctx.batchProjLoc = glGetUniformLocation(ctx.batchProgram, "projection");
+  glUseProgram(ctx.batchProgram);
+  glUniform1i(glGetUniformLocation(ctx.batchProgram, "texture1"), 0);
+
+  // 动态几何环形缓冲，同时作为批处理的顶点与索引缓冲
+  if (!ctx.stream.Create(kStreamBufferSize)) return false;
+  static const char* kStreamModeNames[] = {"persistent", "unsynchronized",
+                                           "orphan"};
+  SDL_Log("Stream buffer: %s mapping",
+          kStreamModeNames[static_cast<int>(ctx.stream.LastFrameStats().mode)]);
+
+  glGenVertexArrays(1, &ctx.batchVAO);
+  glBindVertexArray(ctx.batchVAO);
+  glBindBuffer(GL_ARRAY_BUFFER, ctx.stream.Buffer());
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ctx.stream.Buffer());
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex),
+                        (void*)offsetof(BatchVertex, x));
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex),
+                        (void*)offsetof(BatchVertex, u));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(BatchVertex),
+                        (void*)offsetof(BatchVertex, r));
+  glEnableVertexAttribArray(2);
+  glBindVertexArray(0);
+
+  // ---------------- 实例化着色器与缓冲 ----------------
+  const char* instanceVertexSource = R"(
+    #version 330 core
+    layout(location = 0) in vec3 position;
+    layout(location = 2) in vec4 instanceRect;
+    layout(location = 3) in vec4 instanceUV;
+    layout(location = 4) in vec4 instanceColor;
+
+    uniform mat4 projection;
+    out vec2 TexCoord;
+    out vec4 Color;
+    void main() {
+        vec2 pos = instanceRect.xy + position.xy * instanceRect.zw;
+        gl_Position = projection * vec4(pos, 0.0, 1.0);
+        TexCoord = instanceUV.xy + position.xy * instanceUV.zw;
+        Color = instanceColor;
+    })";
+
+  ctx.instanceProgram =
+      internal::BuildProgram(instanceVertexSource, batchFragmentSource);
+  ctx.instanceProjLoc = glGetUniformLocation(ctx.instanceProgram, "projection");
+  glUseProgram(ctx.instanceProgram);
+  glUniform1i(glGetUniformLocation(ctx.instanceProgram, "texture1"), 0);
 
-  glDeleteShader(vertexShader);
-  glDeleteShader(fragmentShader);
+  glGenVertexArrays(1, &ctx.instanceVAO);
+  glBindVertexArray(ctx.instanceVAO);
+  glBindBuffer(GL_ARRAY_BUFFER, ctx.quadVBO);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+  glEnableVertexAttribArray(0);
+  // 属性指针在每次绘制时按实例结构重新指定
+  glVertexAttribDivisor(2, 1);
+  glVertexAttribDivisor(3, 1);
+  glVertexAttribDivisor(4, 1);
+  glBindVertexArray(0);
+
+  ctx.batch.vertices.reserve(4096);
+  ctx.batch.indices.reserve(6144);
+
+  const uint32_t white = 0xFFFFFFFF;
+  glGenTextures(1, &ctx.whiteTexture);
+  glBindTexture(GL_TEXTURE_2D, ctx.whiteTexture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+               &white);
+
+  // 缓存 uniform 位置，绘制时不再逐次查询
+  const GLuint program = ctx.shaderProgram;
+  ctx.uniforms.projection = glGetUniformLocation(program, "projection");
+  ctx.uniforms.model = glGetUniformLocation(program, "model");
+  ctx.uniforms.uvRect = glGetUniformLocation(program, "uvRect");
+  ctx.uniforms.color = glGetUniformLocation(program, "color");
+  ctx.uniforms.useTexture = glGetUniformLocation(program, "useTexture");
+  ctx.uniforms.texture1 = glGetUniformLocation(program, "texture1");
+
+  // 初始化过程直接操作了 GL 绑定，之后一律经由状态缓存
+  ctx.glState.Invalidate();
+  ctx.glState.stats = GLStateStats{};
 
   // 使用程序并设置投影矩阵
-  glUseProgram(shaderProgram);
-  int width, height;
-  SDL_GetWindowSize(window, &width, &height);
   glViewport(0, 0, width, height);  // 设置viewport
-  s_projection = glm::ortho(0.0f, (float)width, (float)height, 0.0f);
+  ctx.projection = glm::ortho(0.0f, (float)width, (float)height, 0.0f);
 
-  GLint projLoc = glGetUniformLocation(shaderProgram, "projection");
-  glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(s_projection));
+  UseMainProgram(ctx);
+  ctx.glState.Uniform1i(ctx.uniforms.texture1, 0);
 
   return true;
 }
@@ -220,40 +671,31 @@ void main() {
 // ================ 销毁实现 ================
 void Renderer::Shutdown()
 {
-  // 清理资源缓存
-  for (auto& [path, tex] : s_textureCache)
-  {
-    glDeleteTextures(1, &tex->id);
-    delete tex;
-  }
-  s_textureCache.clear();
-
-  for (auto& [key, font] : s_fontCache)
-  {
-    delete font;
-  }
-  s_fontCache.clear();
-
-  // 销毁OpenGL上下文
-  if (s_glContext)
-  {
-    SDL_GL_DeleteContext(s_glContext);
-    s_glContext = nullptr;
-  }
-
-  // 删除VBO和VAO
-  glDeleteVertexArrays(1, &quadVAO);
-  glDeleteBuffers(1, &quadVBO);
-
-  // 重置状态
-  s_window = nullptr;
-  s_glewInitialized = false;
+  internal::DiscardAsyncWork();
+  internal::ShutdownTextureLoader();
+  UnmountAssetPacks();
+#ifdef GFX_ENABLE_PROFILER
+  internal::ProfilerShutdown();
+#endif
+  delete s_default;  // 同时释放其 GL 对象与上下文
 }
 
 // ================ 状态控制 ================
 void Renderer::Clear(Color bg)
 {
   VerifyRenderThread();  // 确保在渲染线程
+  GFX_PROFILE_ZONE("Renderer::Clear");
+  internal::FlushBatch(FlushReason::Interleave);
+
+  int w = 0, h = 0;
+  internal::TargetSize(&w, &h);
+  const Rect screen(0, 0, w, h);
+  if (!internal::DamageTest(screen, [&] {
+        const uint32_t rgba = bg;
+        return internal::HashBytes(&rgba, sizeof rgba);
+      }))
+    return;
+  internal::ApplyDamageScissor();
 
   glClearColor(bg.r / 255.0f, bg.g / 255.0f, bg.b / 255.0f, bg.a / 255.0f);
   glClear(GL_COLOR_BUFFER_BIT);
@@ -262,70 +704,172 @@ void Renderer::Clear(Color bg)
 void Renderer::Present()
 {
   VerifyRenderThread();
-  SDL_GL_SwapWindow(s_window);
+  internal::ContextState& ctx = internal::Ctx();
+  {
+    GFX_PROFILE_ZONE("Renderer::Present");
+    internal::FlushBatch(FlushReason::Present);
+    Renderer::ProcessTextureUploads();  // 新纹理从下一帧开始生效
+    ctx.batch.lastFrameStats = ctx.batch.frameStats;
+    ctx.batch.frameStats = BatchStats{};
+    ctx.stream.EndFrame();
+    // 无损坏的帧不交换，前缓冲内容保持不变；无窗口模式每帧都排队回读
+    const bool damaged = internal::EndDamageFrame();
+    if (internal::IsHeadless())
+      internal::QueueHeadlessReadback();
+    else if (damaged)
+      SDL_GL_SwapWindow(ctx.window);
+  }
+#ifdef GFX_ENABLE_PROFILER
+  if (internal::IsDefaultContext()) internal::ProfilerEndFrame();
+#endif
 }
 
 void Renderer::SetViewport(Rect area)
 {
   VerifyRenderThread();
+  internal::FlushBatch(FlushReason::Interleave);
   glViewport(static_cast<GLint>(area.x), static_cast<GLint>(area.y),
              static_cast<GLsizei>(area.w), static_cast<GLsizei>(area.h));
 }
 
-// ================ 绘图指令 ================
-void Renderer::DrawRect(Rect rect, Color fill)
+void Renderer::SetBlendMode(BlendMode mode)
 {
-  glm::mat4 model =
-      glm::translate(glm::mat4(1.0f), glm::vec3(rect.x, rect.y, 0.0f));
-  model = glm::scale(model, glm::vec3(rect.w, rect.h, 1.0f));
+  internal::ContextState& ctx = internal::Ctx();
+  if (mode == ctx.blendMode) return;
+  internal::FlushBatch(FlushReason::BlendChange);
+  ctx.blendMode = mode;  // 下一次绘制时经由状态缓存生效
+}
 
-  glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE,
-                     &model[0][0]);
-  glUniform1i(glGetUniformLocation(shaderProgram, "useTexture"), GL_FALSE);
-  glUniform4f(glGetUniformLocation(shaderProgram, "color"), fill.r / 255.0f,
-              fill.g / 255.0f, fill.b / 255.0f, fill.a / 255.0f);
+BlendMode Renderer::GetBlendMode()
+{
+  return internal::Ctx().blendMode;
+}
 
-  glBindVertexArray(quadVAO);
-  glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+void Renderer::SetProjection(const glm::mat4& projection)
+{
+  // 已排队的批次在提交时才读取投影矩阵
+  internal::FlushBatch(FlushReason::Interleave);
+  internal::ContextState& ctx = internal::Ctx();
+  // 屏幕上已绘制的内容按旧投影摆放；离屏目标不参与脏区跟踪
+  if (internal::CurrentDamageMode() != DamageMode::Off &&
+      projection != ctx.projection)
+    MarkAllDirty();
+  ctx.projection = projection;
 }
-void Renderer::DrawLine(Point p1, Point p2, Color color, float width)
+
+const glm::mat4& Renderer::GetProjection()
 {
-  glUseProgram(shaderProgram);
-  glm::vec2 points[2] = {glm::vec2(p1.x, p1.y), glm::vec2(p2.x, p2.y)};
+  return internal::Ctx().projection;
+}
 
-  glBindBuffer(GL_ARRAY_BUFFER, lineVBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(points), points, GL_STREAM_DRAW);
+// ================ 批处理控制 ================
+void Renderer::SetBatching(bool enabled)
+{
+  internal::ContextState& ctx = internal::Ctx();
+  VerifyRenderThread();
+  if (!enabled) internal::FlushBatch(FlushReason::Explicit);
+  ctx.batch.enabled = enabled;
+}
 
-  glBindVertexArray(lineVAO);
-  glEnableVertexAttribArray(0);
+bool Renderer::IsBatching()
+{
+  return internal::Ctx().batch.enabled;
+}
+
+void Renderer::Flush()
+{
+  internal::FlushBatch(FlushReason::Explicit);
+}
 
-  glm::mat4 model(1.0f);  // 单位矩阵
-  glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE,
-                     glm::value_ptr(model));
-  glUniform1i(glGetUniformLocation(shaderProgram, "useTexture"), GL_FALSE);
-  glUniform4f(glGetUniformLocation(shaderProgram, "color"), color.r / 255.0f,
-              color.g / 255.0f, color.b / 255.0f, color.a / 255.0f);
+BatchStats Renderer::GetBatchStats()
+{
+  return internal::Ctx().batch.lastFrameStats;
+}
 
-  glLineWidth(width);
-  glDrawArrays(GL_LINES, 0, 2);
+StreamStats Renderer::GetStreamStats()
+{
+  return internal::Ctx().stream.LastFrameStats();
 }
 
+// ================ GL 状态缓存 ================
+GLStateStats Renderer::GetGLStateStats()
+{
+  return internal::Ctx().glState.stats;
+}
+
+void Renderer::ResetGLStateStats()
+{
+  internal::Ctx().glState.stats = GLStateStats{};
+}
+
+void Renderer::InvalidateGLState()
+{
+  internal::Ctx().glState.Invalidate();
+}
+
+// ================ 绘图指令 ================
+void Renderer::DrawRect(Rect rect, Color fill)
+{
+  internal::ContextState& ctx = internal::Ctx();
+  if (!internal::DamageTest(rect, [&] {
+        const uint32_t rgba = fill;
+        return internal::HashBytes(&rgba, sizeof rgba,
+                                   internal::HashBytes(&rect, sizeof rect));
+      }))
+    return;
+
+  if (ctx.batch.enabled)
+  {
+    internal::PushQuad(ctx.whiteTexture, rect, 0.0f, 0.0f, 1.0f, 1.0f, fill);
+    return;
+  }
+
+  UseMainProgram(ctx);
+  glm::mat4 model =
+      glm::translate(glm::mat4(1.0f), glm::vec3(rect.x, rect.y, 0.0f));
+  model = glm::scale(model, glm::vec3(rect.w, rect.h, 1.0f));
+
+  ctx.glState.UniformMatrix4fv(ctx.uniforms.model, &model[0][0]);
+  ctx.glState.Uniform1i(ctx.uniforms.useTexture, GL_FALSE);
+  ctx.glState.Uniform4f(ctx.uniforms.color, fill.r / 255.0f, fill.g / 255.0f,
+                      fill.b / 255.0f, fill.a / 255.0f);
+
+  ctx.glState.BindVertexArray(ctx.quadVAO);
+  internal::ApplyDamageScissor();
+  glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+  ctx.batch.frameStats.drawCalls++;
+  GFX_PROFILE_COUNT(DrawCalls, 1);
+}
 void Renderer::DrawTexture(Texture* tex, Rect dest, float rotation)
 {
-  DrawTexture(tex->id, dest,rotation);
+  DrawTexture(internal::AcquireTexture(tex), dest, rotation);
 }
-void Renderer::DrawTexture(GLuint tex, Rect dest, float rotation)
+// 以 uv=(u0, v0, 宽, 高) 采样纹理的一部分绘制到 dest
+static void DrawTextureRegion(GLuint tex, const Rect& dest, const Rect& uv,
+                              float rotation)
 {
+    internal::ContextState& ctx = internal::Ctx();
     if (tex == 0) {
         std::cerr << "Invalid texture ID!" << std::endl;
         return;
     }
 
-    glUseProgram(shaderProgram);
-    glBindVertexArray(quadVAO);
+    if (!internal::DamageTest(RotatedBounds(dest, rotation), [&] {
+            const float params[9] = {dest.x, dest.y, dest.w, dest.h, rotation,
+                                     uv.x,   uv.y,   uv.w,   uv.h};
+            return internal::HashBytes(params, sizeof params,
+                                       internal::HashBytes(&tex, sizeof tex));
+        }))
+        return;
+
+    if (ctx.batch.enabled) {
+        internal::PushQuad(tex, dest, uv.x, uv.y, uv.x + uv.w, uv.y + uv.h,
+                           White, rotation);
+        return;
+    }
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    UseMainProgram(ctx);
+    ctx.glState.BindVertexArray(ctx.quadVAO);
 
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(dest.x, dest.y, 0.0f));
@@ -338,50 +882,160 @@ void Renderer::DrawTexture(GLuint tex, Rect dest, float rotation)
 
     model = glm::scale(model, glm::vec3(dest.w, dest.h, 1.0f));
 
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-    glUniform1i(glGetUniformLocation(shaderProgram, "useTexture"), GL_TRUE);
-    glUniform4f(glGetUniformLocation(shaderProgram, "color"), 1.0f, 1.0f, 1.0f, 1.0f);
-    
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
-    glUniform4f(glGetUniformLocation(shaderProgram, "uvRect"), 0.0f, 0.0f, 1.0f, 1.0f);
+    ctx.glState.UniformMatrix4fv(ctx.uniforms.model, glm::value_ptr(model));
+    ctx.glState.Uniform1i(ctx.uniforms.useTexture, GL_TRUE);
+    ctx.glState.Uniform4f(ctx.uniforms.color, 1.0f, 1.0f, 1.0f, 1.0f);
 
+    ctx.glState.BindTexture(0, tex);
+    ctx.glState.Uniform4f(ctx.uniforms.uvRect, uv.x, uv.y, uv.w, uv.h);
+
+    internal::ApplyDamageScissor();
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-    glDisable(GL_BLEND);
+    ctx.batch.frameStats.drawCalls++;
+    GFX_PROFILE_COUNT(DrawCalls, 1);
 }
 
+void Renderer::DrawTexture(GLuint tex, Rect dest, float rotation)
+{
+  DrawTextureRegion(tex, dest, Rect(0.0f, 0.0f, 1.0f, 1.0f), rotation);
+}
 
-void Renderer::DrawText(const std::string& text, Point pos, Font* font)
+void Renderer::DrawTexture(const SubTexture& sub, Rect dest, float rotation)
 {
-    if (!font) return;
+  DrawTextureRegion(sub.texture, dest, sub.uv, rotation);
+}
 
-    for (size_t i = 0; i < text.size(); ++i)
+// ================ 实例化绘制 ================
+// 上传实例数组并以单位四边形绘制；uv 为空时使用常量 (0,0,1,1)
+static void DrawInstanced(GLuint tex, const void* data, size_t count,
+                          GLsizei stride, size_t rectOffset, size_t uvOffset,
+                          size_t colorOffset, bool hasUV)
+{
+  internal::ContextState& ctx = internal::Ctx();
+  if (count == 0) return;
+  GFX_PROFILE_ZONE("DrawInstanced");
+  internal::FlushBatch(FlushReason::Interleave);
+  internal::ApplyDamageScissor();
+
+  ctx.glState.UseProgram(ctx.instanceProgram);
+  ctx.glState.UniformMatrix4fv(ctx.instanceProjLoc,
+                               glm::value_ptr(ctx.projection));
+  ctx.glState.SetBlendMode(ctx.blendMode);
+  ctx.glState.BindTexture(0, tex);
+  ctx.glState.BindVertexArray(ctx.instanceVAO);
+
+  glBindBuffer(GL_ARRAY_BUFFER, ctx.stream.Buffer());
+  if (!hasUV)
+  {
+    glDisableVertexAttribArray(3);
+    glVertexAttrib4f(3, 0.0f, 0.0f, 1.0f, 1.0f);
+  }
+
+  // 超过环形缓冲单次分配上限时分块绘制
+  const size_t perChunk = ctx.stream.MaxAllocation() / stride;
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t first = 0; first < count; first += perChunk)
+  {
+    const size_t n = std::min(perChunk, count - first);
+    const GLintptr base =
+        ctx.stream.Upload(bytes + first * stride, n * stride, stride);
+
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride,
+                          (void*)(base + rectOffset));
+    glEnableVertexAttribArray(2);
+    if (hasUV)
     {
-        char32_t codepoint = static_cast<unsigned char>(text[i]); // 仅支持 ASCII
-        const Font::Glyph* glyph = font->GetGlyph(codepoint);
-        if (!glyph) continue;
-
-        // 计算字符纹理左上角位置（相对于基线 pos）
-        gfx::Rect dest(
-            static_cast<float>(pos.x + glyph->bitmap_left),
-            static_cast<float>(pos.y - glyph->bitmap_top),
-            static_cast<float>(glyph->w),
-            static_cast<float>(glyph->h)
-        );
+      glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride,
+                            (void*)(base + uvOffset));
+      glEnableVertexAttribArray(3);
+    }
+    glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                          (void*)(base + colorOffset));
+    glEnableVertexAttribArray(4);
+
+    glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, static_cast<GLsizei>(n));
+    ctx.stream.FenceWritten();
+    ctx.batch.frameStats.drawCalls++;
+    GFX_PROFILE_COUNT(DrawCalls, 1);
+  }
+}
+
+// 实例整体的包围盒与签名；未启用脏区跟踪时不遍历
+template <typename Instance>
+static bool InstancesDamageTest(GLuint tex, const Instance* items,
+                                size_t count)
+{
+  if (internal::CurrentDamageMode() == DamageMode::Off || count == 0)
+    return true;
 
+  float x0 = items[0].rect.x, y0 = items[0].rect.y;
+  float x1 = x0 + items[0].rect.w, y1 = y0 + items[0].rect.h;
+  for (size_t i = 1; i < count; ++i)
+  {
+    const Rect& r = items[i].rect;
+    x0 = std::min(x0, r.x);
+    y0 = std::min(y0, r.y);
+    x1 = std::max(x1, r.x + r.w);
+    y1 = std::max(y1, r.y + r.h);
+  }
+  return internal::DamageTest(Rect(x0, y0, x1 - x0, y1 - y0), [&] {
+    return internal::HashBytes(items, count * sizeof(Instance),
+                               internal::HashBytes(&tex, sizeof tex));
+  });
+}
 
+void Renderer::DrawRectsInstanced(const RectInstance* rects, size_t count)
+{
+  internal::ContextState& ctx = internal::Ctx();
+  if (!InstancesDamageTest(ctx.whiteTexture, rects, count)) return;
+  DrawInstanced(ctx.whiteTexture, rects, count, sizeof(RectInstance),
+                offsetof(RectInstance, rect), 0, offsetof(RectInstance, color),
+                false);
+}
 
-        DrawTexture(glyph->texture, dest);
+void Renderer::DrawSpritesInstanced(GLuint tex, const SpriteInstance* sprites,
+                                    size_t count)
+{
+  if (tex == 0)
+  {
+    std::cerr << "Invalid texture ID!" << std::endl;
+    return;
+  }
+  if (!InstancesDamageTest(tex, sprites, count)) return;
+  DrawInstanced(tex, sprites, count, sizeof(SpriteInstance),
+                offsetof(SpriteInstance, rect), offsetof(SpriteInstance, uv),
+                offsetof(SpriteInstance, color), true);
+}
 
-        // 移动到下一个字符位置
-        pos.x += glyph->advance_x;
-    }
+void Renderer::DrawSpritesInstanced(Texture* tex,
+                                    const SpriteInstance* sprites, size_t count)
+{
+  DrawSpritesInstanced(tex ? internal::AcquireTexture(tex) : 0, sprites,
+                       count);
 }
 
+Texture::~Texture()
+{
+  internal::ForgetCachedTexture(this);
+  // 加载未完成或失败时 id 是共享的占位纹理，不能删除
+  if (!record_ || internal::CancelTextureLoad(this))
+    internal::DeleteTexture(id);
+  if (record_)
+  {
+    if (GLsync fence = record_->fence.load(std::memory_order_acquire))
+      glDeleteSync(fence);
+    delete record_;
+  }
+}
+
+void Texture::Bind(GLuint unit) const
+{
+  internal::Ctx().glState.BindTexture(unit, internal::AcquireTexture(this));
+}
 
 Texture* Renderer::CreateTexture(int width, int height)
 {
+  internal::ContextState& ctx = internal::Ctx();
   if (width <= 0 || height <= 0)
   {
     std::cerr << "Invalid texture dimensions: " << width << "x" << height
@@ -391,7 +1045,7 @@ Texture* Renderer::CreateTexture(int width, int height)
 
   GLuint textureID;
   glGenTextures(1, &textureID);
-  glBindTexture(GL_TEXTURE_2D, textureID);
+  ctx.glState.BindTexture(0, textureID);
 
   // 设置默认纹理参数
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -408,206 +1062,10 @@ Texture* Renderer::CreateTexture(int width, int height)
   if (err != GL_NO_ERROR)
   {
     std::cerr << "Failed to create texture: " << err << std::endl;
-    glDeleteTextures(1, &textureID);
+    internal::DeleteTexture(textureID);
     return nullptr;
   }
 
   return new Texture{textureID, width, height};
 }
-Texture* Renderer::LoadTexture(const std::string& path)
-{
-  // 使用SDL_image加载图像
-  SDL_Surface* surface = IMG_Load(path.c_str());
-  if (!surface)
-  {
-    std::cerr << "Failed to load image: " << path << " - " << IMG_GetError()
-              << std::endl;
-    return nullptr;
-  }
-
-  // 转换为RGBA格式（如果还不是）
-  SDL_Surface* converted =
-      SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
-  SDL_FreeSurface(surface);
-
-  if (!converted)
-  {
-    std::cerr << "Failed to convert image: " << path << std::endl;
-    return nullptr;
-  }
-
-  // 创建OpenGL纹理
-  GLuint textureID;
-  glGenTextures(1, &textureID);
-  glBindTexture(GL_TEXTURE_2D, textureID);
-
-  // 设置纹理参数
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-  // 上传纹理数据
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, converted->w, converted->h, 0,
-               GL_RGBA, GL_UNSIGNED_BYTE, converted->pixels);
-  glGenerateMipmap(GL_TEXTURE_2D);
-
-  // 清理SDL表面
-  SDL_FreeSurface(converted);
-
-  // 检查错误
-  GLenum err = glGetError();
-  if (err != GL_NO_ERROR)
-  {
-    std::cerr << "Failed to upload texture: " << err << std::endl;
-    glDeleteTextures(1, &textureID);
-    return nullptr;
-  }
-
-  return new Texture{textureID, converted->w, converted->h};
-}
-void Renderer::ReleaseTexture(Texture* tex)
-{
-  if (!tex) return;
-
-  if (tex->id)
-  {
-    glDeleteTextures(1, &tex->id);
-  }
-  delete tex;
-}
-Font* Font::Load(const std::string& path, int size,Color color)
-{
-    FT_Library library;
-    FT_Face face;
-    FT_Error error;
-
-    // 1. 初始化 FreeType
-    error = FT_Init_FreeType(&library);
-    if (error) {
-        fprintf(stderr, "INFO :Unable to initialize FreeType library\n");
-        return nullptr;
-    }
-
-    // 2. 加载字体文件
-    error = FT_New_Face(library, path.c_str(), 0, &face);
-    if (error) {
-        fprintf(stderr, "INFO :Unable to load font file: %s\n", path.c_str());
-        FT_Done_FreeType(library);
-        return nullptr;
-    }
-
-    // 3. 设置字体大小
-    error = FT_Set_Pixel_Sizes(face, 0, size);
-    if (error) {
-        fprintf(stderr, "INFO :Unable to set font size\n");
-        FT_Done_Face(face);
-        FT_Done_FreeType(library);
-        return nullptr;
-    }
-
-    // 4. 创建 Font 对象
-    Font* font = new Font();
-    font->size=size;
-    // 5. 加载 ASCII 字符
-    for (int i = 0; i < 128; ++i) {
-        if (FT_Load_Char(face, i, FT_LOAD_RENDER)) {
-            fprintf(stderr, "INFO :Unable to load character: %c (ASCII %d)\n", (char)i, i);
-            continue;
-        }
-
-        FT_GlyphSlot slot = face->glyph;
-        FT_Bitmap bitmap = slot->bitmap;
-
-        int width = bitmap.width;
-        int height = bitmap.rows;
-        uint8_t* grayBuffer = bitmap.buffer;
-
-        // 转换成 RGBA：白色字体 + 灰度做透明度
-        std::vector<uint8_t> rgbaBuffer(width * height * 4);
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                int i = y * width + x;
-                uint8_t alpha = grayBuffer[i];
-
-                rgbaBuffer[i * 4 + 0] = color.r; // R（白色）
-                rgbaBuffer[i * 4 + 1] = color.g; // G
-                rgbaBuffer[i * 4 + 2] = color.b; // B
-                rgbaBuffer[i * 4 + 3] = alpha; // A
-            }
-        }
-
-        // 创建 OpenGL 纹理
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RGBA,
-            width,
-            height,
-            0,
-            GL_RGBA,
-            GL_UNSIGNED_BYTE,
-            rgbaBuffer.data()
-        );
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        // 存储字符信息
-        font->glyphs[(char32_t)i] = Glyph{
-            static_cast<int>(slot->bitmap_left),
-            static_cast<int>(slot->bitmap_top),
-            static_cast<int>(slot->advance.x >> 6),
-            texture,
-            width,
-            height
-        };
-    }
-
-    // 6. 清理
-    FT_Done_Face(face);
-    FT_Done_FreeType(library);
-
-    // 7. 返回字体
-    return font;
-}
-
-
-
-
-void Font::Release(Font* font)
-{
-    if (font)
-    {
-        // 释放纹理资源
-        for (auto& pair : font->glyphs)
-        {
-            GLuint texture = pair.second.texture;
-            glDeleteTextures(1, &texture); // 删除 OpenGL 纹理
-        }
-
-        // 删除 Font 对象
-        delete font;
-    }
-}
-
-const Font::Glyph* Font::GetGlyph(char32_t codepoint) const
-{
-  auto it = glyphs.find(codepoint);
-  if (it != glyphs.end()) return &it->second;
-  else{
-
-  }
-  return nullptr;
-}
-
 }  // namespace gfx
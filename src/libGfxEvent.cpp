@@ -1,14 +1,150 @@
 #include "../include/libGfxEvent.h"
 #include <SDL2/SDL.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
 namespace gfx {
 namespace Event {
 namespace internal {
-    std::unordered_map<EventType, std::vector<EventCallback>> eventListeners;
-    std::unordered_map<KeyCode, bool> keyStates;
-    std::unordered_map<MouseButton, bool> mouseButtonStates;
+    // 按枚举值直接索引；表长取各枚举的最后一项
+    constexpr size_t kEventTypeCount = static_cast<size_t>(EventType::MouseLeave) + 1;
+    constexpr size_t kKeyCount = static_cast<size_t>(KeyCode::RControl) + 1;
+    constexpr size_t kMouseButtonCount = static_cast<size_t>(MouseButton::Unknown) + 1;
+
+    // 监听器槽位：deque 扩容不移动已有元素，回调执行期间新增监听器也安全
+    struct ListenerSlot {
+        EventCallback callback;
+        uint32_t generation = 1;
+        EventType type = EventType::None;
+        bool alive = false;
+    };
+
+    // 每种事件按注册顺序记录槽位下标；移除只做标记，之后统一压缩
+    struct ListenerList {
+        std::vector<uint32_t> slots;
+        size_t dead = 0;
+    };
+
+    std::deque<ListenerSlot> listenerSlots;
+    std::vector<uint32_t> freeSlots;
+    std::array<ListenerList, kEventTypeCount> eventListeners;
+    int dispatchDepth = 0;
+    bool compactPending = false;
+
+    // 区域监听器：同样按槽位存放，另有一张均匀网格记录每个格子覆盖到的区域
+    struct Region {
+        Rect rect{0.0f, 0.0f, 0.0f, 0.0f};
+        int z = 0;
+        uint32_t order = 0;         // 同一 z 下后加的在上面
+        uint32_t generation = 1;
+        EventType type = EventType::None;
+        bool alive = false;
+        bool inside = false;        // 光标是否在区域内（仅进入/离开区域）
+        // 已登记的格子范围（含两端）；空矩形不进网格
+        int32_t x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+        EventCallback callback;
+    };
+
+    std::deque<Region> regions;
+    std::vector<uint32_t> freeRegions;
+    std::vector<uint32_t> deadRegions;      // 派发中移除的，派发结束后回收
+    std::vector<uint32_t> hoveredRegions;   // inside 为真的区域
+    // 格子只增不删，避免控件来回移动时反复分配
+    std::unordered_map<uint64_t, std::vector<uint32_t>> regionGrid;
+    float regionCellSize = 64.0f;
+    uint32_t regionOrder = 0;
+
+    std::bitset<kKeyCount> keyStates;
+    std::bitset<kMouseButtonCount> mouseButtonStates;
     Point currentMousePosition;
     bool textInputActive = false;
+
+    // 合并模式下尚未派发的移动事件
+    bool coalesceMotion = false;
+    bool motionPending = false;
+    Event pendingMotion{};
+
+    // 单生产者单消费者环形队列：head 只由生产者写，tail 只由消费者写，
+    // 两者分处不同缓存行，避免伪共享
+    class EventRing {
+    public:
+        void Reset(size_t capacity) {
+            size_t size = 1;
+            while (size < capacity) size <<= 1;
+            slots_.reset(new Event[size]);
+            mask_ = size - 1;
+            head_.store(0, std::memory_order_relaxed);
+            tail_.store(0, std::memory_order_relaxed);
+            queued_.store(0, std::memory_order_relaxed);
+            dropped_.store(0, std::memory_order_relaxed);
+            highWater_.store(0, std::memory_order_relaxed);
+        }
+
+        void Release() {
+            slots_.reset();
+            mask_ = 0;
+        }
+
+        // 生产者线程
+        bool Push(const Event& event) {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            const size_t used = head - tail_.load(std::memory_order_acquire);
+            if (used > mask_) {
+                dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+                               std::memory_order_relaxed);
+                return false;
+            }
+            slots_[head & mask_] = event;
+            head_.store(head + 1, std::memory_order_release);
+            queued_.store(queued_.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+            if (used + 1 > highWater_.load(std::memory_order_relaxed))
+                highWater_.store(static_cast<uint32_t>(used + 1), std::memory_order_relaxed);
+            return true;
+        }
+
+        // 消费者线程
+        size_t Pop(Event* out, size_t maxEvents) {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            const size_t available = head_.load(std::memory_order_acquire) - tail;
+            const size_t n = std::min(available, maxEvents);
+            for (size_t i = 0; i < n; ++i) out[i] = slots_[(tail + i) & mask_];
+            tail_.store(tail + n, std::memory_order_release);
+            return n;
+        }
+
+        EventQueueStats Stats() const {
+            EventQueueStats stats;
+            stats.queued = queued_.load(std::memory_order_relaxed);
+            stats.dropped = dropped_.load(std::memory_order_relaxed);
+            stats.capacity = slots_ ? static_cast<uint32_t>(mask_ + 1) : 0;
+            stats.highWater = highWater_.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    private:
+        std::unique_ptr<Event[]> slots_;
+        size_t mask_ = 0;
+        alignas(64) std::atomic<size_t> head_{0};
+        alignas(64) std::atomic<size_t> tail_{0};
+        // 计数只由生产者写，消费者读取时允许略有滞后
+        alignas(64) std::atomic<uint64_t> queued_{0};
+        std::atomic<uint64_t> dropped_{0};
+        std::atomic<uint32_t> highWater_{0};
+    };
+
+    EventRing eventQueue;
+    std::atomic<bool> queueEnabled{false};
 }
 
 // Convert SDL keycode to our KeyCode
@@ -103,7 +239,335 @@ static MouseButton ConvertSDLMouseButton(Uint8 button) {
     }
 }
 
+static uint64_t NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// ==================== 输入录制 ====================
+// 日志格式：12 字节文件头（魔数、版本、开始录制时的 SDL 时间），之后逐条记录：
+// 1 字节类型、距上一条的毫秒数，再按类型写字段。整数用 varint，有符号数先做
+// zigzag，常见事件只占 4~8 字节
+namespace internal {
+    constexpr char kRecordMagic[4] = {'G', 'F', 'X', 'I'};
+    constexpr uint16_t kRecordVersion = 1;
+    constexpr size_t kRecordHeaderSize = 12;
+    constexpr size_t kRecordFlushSize = 64 * 1024;
+
+    enum class RecordKind : uint8_t {
+        MouseButtonDown,
+        MouseButtonUp,
+        MouseMotion,
+        KeyDown,
+        KeyUp
+    };
+
+    // 记录先攒在缓冲里，满了再写文件
+    struct Recorder {
+        std::ofstream out;
+        std::vector<uint8_t> buffer;
+        uint32_t lastTicks = 0;
+        size_t events = 0;
+
+        void Flush() {
+            out.write(reinterpret_cast<const char*>(buffer.data()),
+                      static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+        ~Recorder() { Flush(); }
+    };
+
+    std::unique_ptr<Recorder> recorder;
+}
+
+static void PutFixed(std::vector<uint8_t>& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+static uint32_t GetFixed(const std::vector<uint8_t>& in, size_t pos, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; ++i) value |= static_cast<uint32_t>(in[pos + i]) << (8 * i);
+    return value;
+}
+
+static void PutVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static void PutSigned(std::vector<uint8_t>& out, int32_t value) {
+    PutVarint(out, (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+}
+
+static bool GetVarint(const std::vector<uint8_t>& in, size_t& pos, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35 && pos < in.size(); shift += 7) {
+        const uint8_t byte = in[pos++];
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static bool GetSigned(const std::vector<uint8_t>& in, size_t& pos, int32_t& value) {
+    uint32_t raw;
+    if (!GetVarint(in, pos, raw)) return false;
+    value = static_cast<int32_t>((raw >> 1) ^ (0u - (raw & 1)));
+    return true;
+}
+
+static void RecordEvent(const SDL_Event& sdlEvent) {
+    internal::Recorder& recorder = *internal::recorder;
+    std::vector<uint8_t>& out = recorder.buffer;
+    auto begin = [&](internal::RecordKind kind) {
+        // 时间戳回退（如合成事件）时按零间隔记录
+        const uint32_t ticks = std::max(sdlEvent.common.timestamp, recorder.lastTicks);
+        out.push_back(static_cast<uint8_t>(kind));
+        PutVarint(out, ticks - recorder.lastTicks);
+        recorder.lastTicks = ticks;
+    };
+
+    switch (sdlEvent.type) {
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            begin(sdlEvent.type == SDL_MOUSEBUTTONDOWN ? internal::RecordKind::MouseButtonDown
+                                                       : internal::RecordKind::MouseButtonUp);
+            out.push_back(sdlEvent.button.button);
+            out.push_back(sdlEvent.button.clicks);
+            PutSigned(out, sdlEvent.button.x);
+            PutSigned(out, sdlEvent.button.y);
+            break;
+
+        case SDL_MOUSEMOTION:
+            begin(internal::RecordKind::MouseMotion);
+            PutVarint(out, sdlEvent.motion.state);
+            PutSigned(out, sdlEvent.motion.x);
+            PutSigned(out, sdlEvent.motion.y);
+            PutSigned(out, sdlEvent.motion.xrel);
+            PutSigned(out, sdlEvent.motion.yrel);
+            break;
+
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            begin(sdlEvent.type == SDL_KEYDOWN ? internal::RecordKind::KeyDown
+                                               : internal::RecordKind::KeyUp);
+            PutSigned(out, sdlEvent.key.keysym.sym);
+            PutVarint(out, sdlEvent.key.keysym.mod);
+            out.push_back(sdlEvent.key.repeat);
+            break;
+
+        default:
+            return;  // PollEvents 不翻译的事件不录
+    }
+
+    ++recorder.events;
+    if (out.size() >= internal::kRecordFlushSize) recorder.Flush();
+}
+
+// 去掉已移除的槽位并回收，保持其余监听器的顺序
+static void Compact(internal::ListenerList& list) {
+    auto alive = std::remove_if(list.slots.begin(), list.slots.end(), [](uint32_t index) {
+        internal::ListenerSlot& slot = internal::listenerSlots[index];
+        if (slot.alive) return false;
+        slot.callback.Reset();
+        if (++slot.generation == 0) slot.generation = 1;
+        internal::freeSlots.push_back(index);
+        return true;
+    });
+    list.slots.erase(alive, list.slots.end());
+    list.dead = 0;
+}
+
+// ==================== 区域命中 ====================
+static int32_t CellCoord(float v) {
+    return static_cast<int32_t>(std::floor(v / internal::regionCellSize));
+}
+
+static uint64_t CellKey(int32_t cx, int32_t cy) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+}
+
+static bool Contains(const Rect& rect, const Point& p) {
+    return p.x >= rect.x && p.x < rect.x + rect.w && p.y >= rect.y && p.y < rect.y + rect.h;
+}
+
+static bool Above(const internal::Region& a, const internal::Region& b) {
+    return a.z != b.z ? a.z > b.z : a.order > b.order;
+}
+
+static bool IsRegionEventType(EventType type) {
+    switch (type) {
+        case EventType::MouseButtonDown:
+        case EventType::MouseButtonUp:
+        case EventType::MouseMotion:
+        case EventType::MouseEnter:
+        case EventType::MouseLeave:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static const std::vector<uint32_t>* CellAt(const Point& p) {
+    auto it = internal::regionGrid.find(CellKey(CellCoord(p.x), CellCoord(p.y)));
+    return it != internal::regionGrid.end() ? &it->second : nullptr;
+}
+
+// 把区域登记的格子范围改成 rect 覆盖的范围，只增删进出的格子
+static void UpdateRegionCells(uint32_t index, const Rect* rect) {
+    internal::Region& region = internal::regions[index];
+    int32_t x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+    if (rect && rect->w > 0 && rect->h > 0) {
+        x0 = CellCoord(rect->x);
+        y0 = CellCoord(rect->y);
+        x1 = CellCoord(rect->x + rect->w);
+        y1 = CellCoord(rect->y + rect->h);
+    }
+
+    for (int32_t cy = region.y0; cy <= region.y1; ++cy) {
+        for (int32_t cx = region.x0; cx <= region.x1; ++cx) {
+            if (cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1) continue;
+            std::vector<uint32_t>& cell = internal::regionGrid[CellKey(cx, cy)];
+            auto it = std::find(cell.begin(), cell.end(), index);
+            *it = cell.back();
+            cell.pop_back();
+        }
+    }
+    for (int32_t cy = y0; cy <= y1; ++cy) {
+        for (int32_t cx = x0; cx <= x1; ++cx) {
+            if (cx >= region.x0 && cx <= region.x1 && cy >= region.y0 && cy <= region.y1)
+                continue;
+            internal::regionGrid[CellKey(cx, cy)].push_back(index);
+        }
+    }
+    region.x0 = x0;
+    region.y0 = y0;
+    region.x1 = x1;
+    region.y1 = y1;
+}
+
+static void FreeRegion(uint32_t index) {
+    internal::Region& region = internal::regions[index];
+    region.callback.Reset();
+    if (++region.generation == 0) region.generation = 1;
+    internal::freeRegions.push_back(index);
+}
+
+static internal::Region* FindRegion(RegionHandle handle) {
+    if (!handle || handle.index >= internal::regions.size()) return nullptr;
+    internal::Region& region = internal::regions[handle.index];
+    return region.alive && region.generation == handle.generation ? &region : nullptr;
+}
+
+// 移动事件：先通知离开的区域，再通知进入的区域，各自按自上而下的顺序
+static void UpdateHover(const Event& motion) {
+    const Point p = motion.mouse.position;
+    std::vector<uint32_t> notify;   // 只有进出区域时才分配
+
+    std::vector<uint32_t>& hovered = internal::hoveredRegions;
+    for (size_t i = 0; i < hovered.size();) {
+        internal::Region& region = internal::regions[hovered[i]];
+        if (Contains(region.rect, p)) {
+            ++i;
+            continue;
+        }
+        region.inside = false;
+        if (region.type == EventType::MouseLeave) notify.push_back(hovered[i]);
+        hovered[i] = hovered.back();
+        hovered.pop_back();
+    }
+    const size_t leaving = notify.size();
+
+    if (const std::vector<uint32_t>* cell = CellAt(p)) {
+        for (uint32_t index : *cell) {
+            internal::Region& region = internal::regions[index];
+            if (region.inside || !Contains(region.rect, p) ||
+                (region.type != EventType::MouseEnter && region.type != EventType::MouseLeave))
+                continue;
+            region.inside = true;
+            hovered.push_back(index);
+            if (region.type == EventType::MouseEnter) notify.push_back(index);
+        }
+    }
+    if (notify.empty()) return;
+
+    auto topFirst = [](uint32_t a, uint32_t b) {
+        return Above(internal::regions[a], internal::regions[b]);
+    };
+    std::sort(notify.begin(), notify.begin() + leaving, topFirst);
+    std::sort(notify.begin() + leaving, notify.end(), topFirst);
+
+    // 回调里可能增删区域，逐个重新检查
+    Event event = motion;
+    for (size_t i = 0; i < notify.size(); ++i) {
+        internal::Region& region = internal::regions[notify[i]];
+        if (!region.alive) continue;
+        event.type = i < leaving ? EventType::MouseLeave : EventType::MouseEnter;
+        region.callback(event);
+    }
+}
+
+static void DispatchRegions(const Event& event) {
+    if (event.type == EventType::MouseMotion) UpdateHover(event);
+
+    const std::vector<uint32_t>* cell = CellAt(event.mouse.position);
+    if (!cell) return;
+    const internal::Region* top = nullptr;
+    uint32_t topIndex = 0;
+    for (uint32_t index : *cell) {
+        const internal::Region& region = internal::regions[index];
+        if (region.type != event.type || !Contains(region.rect, event.mouse.position)) continue;
+        if (!top || Above(region, *top)) {
+            top = &region;
+            topIndex = index;
+        }
+    }
+    if (top) internal::regions[topIndex].callback(event);
+}
+
+static void Dispatch(const Event& event) {
+    const internal::ListenerList& list = internal::eventListeners[static_cast<size_t>(event.type)];
+    // 按下标遍历且长度固定：回调里新增的监听器从下一个事件开始生效
+    ++internal::dispatchDepth;
+    const size_t count = list.slots.size();
+    for (size_t i = 0; i < count; ++i) {
+        internal::ListenerSlot& slot = internal::listenerSlots[list.slots[i]];
+        if (slot.alive) slot.callback(event);
+    }
+    if (event.type == EventType::MouseButtonDown || event.type == EventType::MouseButtonUp ||
+        event.type == EventType::MouseMotion)
+        DispatchRegions(event);
+    if (--internal::dispatchDepth > 0 || !internal::compactPending) return;
+
+    internal::compactPending = false;
+    for (auto& pending : internal::eventListeners) {
+        if (pending.dead > 0) Compact(pending);
+    }
+    for (uint32_t index : internal::deadRegions) FreeRegion(index);
+    internal::deadRegions.clear();
+}
+
+// 队列模式下入队，否则立即通知监听器
+static void Deliver(const Event& event) {
+    if (internal::queueEnabled.load(std::memory_order_relaxed))
+        internal::eventQueue.Push(event);
+    else
+        Dispatch(event);
+}
+
+static void FlushPendingMotion() {
+    if (!internal::motionPending) return;
+    internal::motionPending = false;
+    Deliver(internal::pendingMotion);
+}
+
 void PollEvents(SDL_Event &sdlEvent) {
+        if (internal::recorder) RecordEvent(sdlEvent);
+
         Event event{};
         switch (sdlEvent.type) {
             case SDL_MOUSEBUTTONDOWN:
@@ -112,7 +576,7 @@ void PollEvents(SDL_Event &sdlEvent) {
                 event.mouse.position = {static_cast<float>(sdlEvent.button.x), 
                                       static_cast<float>(sdlEvent.button.y)};
                 event.mouse.clicks = sdlEvent.button.clicks;
-                internal::mouseButtonStates[event.mouse.button] = true;
+                internal::mouseButtonStates[static_cast<size_t>(event.mouse.button)] = true;
                 break;
                 
             case SDL_MOUSEBUTTONUP:
@@ -120,7 +584,7 @@ void PollEvents(SDL_Event &sdlEvent) {
                 event.mouse.button = ConvertSDLMouseButton(sdlEvent.button.button);
                 event.mouse.position = {static_cast<float>(sdlEvent.button.x), 
                                       static_cast<float>(sdlEvent.button.y)};
-                internal::mouseButtonStates[event.mouse.button] = false;
+                internal::mouseButtonStates[static_cast<size_t>(event.mouse.button)] = false;
                 break;
                 
             case SDL_MOUSEMOTION:
@@ -136,35 +600,365 @@ void PollEvents(SDL_Event &sdlEvent) {
                 event.type = EventType::KeyDown;
                 event.keyboard.keycode = ConvertSDLKeyCode(sdlEvent.key.keysym.sym);
                 event.keyboard.repeat = sdlEvent.key.repeat;
-                internal::keyStates[event.keyboard.keycode] = true;
+                internal::keyStates[static_cast<size_t>(event.keyboard.keycode)] = true;
                 break;
                 
             case SDL_KEYUP:
                 event.type = EventType::KeyUp;
                 event.keyboard.keycode = ConvertSDLKeyCode(sdlEvent.key.keysym.sym);
-                internal::keyStates[event.keyboard.keycode] = false;
+                internal::keyStates[static_cast<size_t>(event.keyboard.keycode)] = false;
                 break;
         }
         
-        // Notify listeners
-        if (event.type != EventType::None) {
-            for (auto& callback : internal::eventListeners[event.type]) {
-                callback(event);
+        if (event.type == EventType::None) return;
+        event.timestamp = sdlEvent.common.timestamp;
+        event.timeNs = NowNs();
+
+        // 合并连续的移动事件：保留最新位置，累加相对位移
+        if (internal::coalesceMotion && event.type == EventType::MouseMotion) {
+            if (internal::motionPending) {
+                event.mouse.relative.x += internal::pendingMotion.mouse.relative.x;
+                event.mouse.relative.y += internal::pendingMotion.mouse.relative.y;
             }
+            internal::pendingMotion = event;
+            internal::motionPending = true;
+            return;
+        }
+
+        // 其它事件之前先派发积攒的移动，保持先后顺序
+        FlushPendingMotion();
+
+        // Notify listeners
+        Deliver(event);
+}
+
+ListenerHandle AddListener(EventType type, EventCallback callback) {
+    uint32_t index;
+    if (!internal::freeSlots.empty()) {
+        index = internal::freeSlots.back();
+        internal::freeSlots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(internal::listenerSlots.size());
+        internal::listenerSlots.emplace_back();
+    }
+
+    internal::ListenerSlot& slot = internal::listenerSlots[index];
+    slot.callback = std::move(callback);
+    slot.type = type;
+    slot.alive = true;
+    internal::eventListeners[static_cast<size_t>(type)].slots.push_back(index);
+    return {index, slot.generation};
+}
+
+bool RemoveListener(ListenerHandle handle) {
+    if (!handle || handle.index >= internal::listenerSlots.size()) return false;
+    internal::ListenerSlot& slot = internal::listenerSlots[handle.index];
+    if (!slot.alive || slot.generation != handle.generation) return false;
+
+    slot.alive = false;
+    internal::ListenerList& list = internal::eventListeners[static_cast<size_t>(slot.type)];
+    ++list.dead;
+    if (internal::dispatchDepth > 0) {
+        // 派发中不能销毁正在执行的回调，等派发结束再压缩
+        internal::compactPending = true;
+        return true;
+    }
+
+    slot.callback.Reset();
+    // 失效项超过一半时压缩，均摊 O(1)
+    if (list.dead * 2 > list.slots.size()) Compact(list);
+    return true;
+}
+
+RegionHandle AddRegionListener(const Rect& rect, EventType type, EventCallback callback, int z) {
+    if (!IsRegionEventType(type)) return {};
+    uint32_t index;
+    if (!internal::freeRegions.empty()) {
+        index = internal::freeRegions.back();
+        internal::freeRegions.pop_back();
+    } else {
+        index = static_cast<uint32_t>(internal::regions.size());
+        internal::regions.emplace_back();
+    }
+
+    internal::Region& region = internal::regions[index];
+    region.rect = rect;
+    region.z = z;
+    region.order = ++internal::regionOrder;
+    region.type = type;
+    region.alive = true;
+    region.inside = false;
+    region.callback = std::move(callback);
+    UpdateRegionCells(index, &rect);
+    return {index, region.generation};
+}
+
+bool RemoveRegionListener(RegionHandle handle) {
+    internal::Region* region = FindRegion(handle);
+    if (!region) return false;
+
+    UpdateRegionCells(handle.index, nullptr);
+    if (region->inside) {
+        std::vector<uint32_t>& hovered = internal::hoveredRegions;
+        hovered.erase(std::find(hovered.begin(), hovered.end(), handle.index));
+        region->inside = false;
+    }
+    region->alive = false;
+    if (internal::dispatchDepth > 0) {
+        // 回调可能正在执行，派发结束后再回收
+        internal::deadRegions.push_back(handle.index);
+        internal::compactPending = true;
+    } else {
+        FreeRegion(handle.index);
+    }
+    return true;
+}
+
+bool SetRegionRect(RegionHandle handle, const Rect& rect) {
+    internal::Region* region = FindRegion(handle);
+    if (!region) return false;
+    region->rect = rect;
+    UpdateRegionCells(handle.index, &rect);
+    return true;
+}
+
+bool SetRegionZ(RegionHandle handle, int z) {
+    internal::Region* region = FindRegion(handle);
+    if (!region) return false;
+    region->z = z;
+    return true;
+}
+
+void SetRegionCellSize(float size) {
+    if (!(size > 0.0f) || size == internal::regionCellSize) return;
+    internal::regionGrid.clear();
+    internal::regionCellSize = size;
+    for (uint32_t index = 0; index < internal::regions.size(); ++index) {
+        internal::Region& region = internal::regions[index];
+        region.x0 = region.y0 = 0;
+        region.x1 = region.y1 = -1;
+        if (region.alive) UpdateRegionCells(index, &region.rect);
+    }
+}
+
+void SetMotionCoalescing(bool enabled) {
+    if (!enabled) FlushPendingMotion();
+    internal::coalesceMotion = enabled;
+}
+
+bool IsMotionCoalescing() {
+    return internal::coalesceMotion;
+}
+
+void DispatchPending() {
+    FlushPendingMotion();
+}
+
+void EnableEventQueue(size_t capacity) {
+    internal::queueEnabled.store(false, std::memory_order_relaxed);
+    internal::eventQueue.Reset(std::max<size_t>(capacity, 1));
+    internal::queueEnabled.store(true, std::memory_order_release);
+}
+
+void DisableEventQueue() {
+    internal::queueEnabled.store(false, std::memory_order_relaxed);
+    internal::eventQueue.Release();
+}
+
+bool IsEventQueueEnabled() {
+    return internal::queueEnabled.load(std::memory_order_relaxed);
+}
+
+size_t DrainEvents(Event* out, size_t maxEvents) {
+    if (!internal::queueEnabled.load(std::memory_order_acquire)) return 0;
+    return internal::eventQueue.Pop(out, maxEvents);
+}
+
+size_t DispatchQueuedEvents() {
+    // 分批取出到栈上缓冲，不分配内存；取到不满一批即结束
+    constexpr size_t kBatch = 64;
+    Event batch[kBatch];
+    size_t total = 0, n;
+    do {
+        n = DrainEvents(batch, kBatch);
+        for (size_t i = 0; i < n; ++i) Dispatch(batch[i]);
+        total += n;
+    } while (n == kBatch);
+    return total;
+}
+
+EventQueueStats GetEventQueueStats() {
+    return internal::eventQueue.Stats();
+}
+
+bool StartRecording(const std::string& path) {
+    StopRecording();
+    auto recorder = std::make_unique<internal::Recorder>();
+    recorder->out.open(path, std::ios::binary | std::ios::trunc);
+    if (!recorder->out) {
+        std::cerr << "Failed to create input recording: " << path << std::endl;
+        return false;
+    }
+
+    recorder->lastTicks = SDL_GetTicks();
+    std::vector<uint8_t>& header = recorder->buffer;
+    header.insert(header.end(), std::begin(internal::kRecordMagic), std::end(internal::kRecordMagic));
+    PutFixed(header, internal::kRecordVersion, 2);
+    PutFixed(header, 0, 2);
+    PutFixed(header, recorder->lastTicks, 4);
+    internal::recorder = std::move(recorder);
+    return true;
+}
+
+size_t StopRecording() {
+    if (!internal::recorder) return 0;
+    internal::Recorder& recorder = *internal::recorder;
+    recorder.Flush();
+    if (!recorder.out)
+        std::cerr << "Failed to write input recording" << std::endl;
+    const size_t events = recorder.events;
+    internal::recorder.reset();
+    return events;
+}
+
+bool IsRecording() {
+    return internal::recorder != nullptr;
+}
+
+// ==================== InputReplay ====================
+InputReplay* InputReplay::Open(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Failed to open input recording: " << path << std::endl;
+        return nullptr;
+    }
+
+    std::unique_ptr<InputReplay> replay(new InputReplay());
+    std::vector<uint8_t>& data = replay->data_;
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (data.size() < internal::kRecordHeaderSize ||
+        std::memcmp(data.data(), internal::kRecordMagic, sizeof internal::kRecordMagic) != 0 ||
+        GetFixed(data, 4, 2) != internal::kRecordVersion) {
+        std::cerr << "Invalid input recording: " << path << std::endl;
+        return nullptr;
+    }
+    replay->startTicks_ = GetFixed(data, 8, 4);
+
+    // 先完整解码一遍：校验记录，并得到事件数与总时长
+    replay->Rewind();
+    while (replay->hasNext_) {
+        ++replay->eventCount_;
+        replay->ReadNext();
+    }
+    if (replay->cursor_ != data.size()) {
+        std::cerr << "Truncated input recording: " << path << std::endl;
+        return nullptr;
+    }
+    replay->duration_ = replay->nextTime_;
+    replay->Rewind();
+    return replay.release();
+}
+
+// 解码下一条记录到 next_；到末尾或数据损坏时停在原处
+bool InputReplay::ReadNext() {
+    hasNext_ = false;
+    size_t pos = cursor_;
+    if (pos >= data_.size()) return false;
+    const auto kind = static_cast<internal::RecordKind>(data_[pos++]);
+    uint32_t delta;
+    if (!GetVarint(data_, pos, delta)) return false;
+
+    SDL_Event event{};
+    bool ok = true;
+    switch (kind) {
+        case internal::RecordKind::MouseButtonDown:
+        case internal::RecordKind::MouseButtonUp: {
+            const bool down = kind == internal::RecordKind::MouseButtonDown;
+            if (pos + 2 > data_.size()) return false;
+            event.type = down ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+            event.button.state = down ? SDL_PRESSED : SDL_RELEASED;
+            event.button.button = data_[pos++];
+            event.button.clicks = data_[pos++];
+            ok = GetSigned(data_, pos, event.button.x) && GetSigned(data_, pos, event.button.y);
+            break;
+        }
+
+        case internal::RecordKind::MouseMotion:
+            event.type = SDL_MOUSEMOTION;
+            ok = GetVarint(data_, pos, event.motion.state) &&
+                 GetSigned(data_, pos, event.motion.x) &&
+                 GetSigned(data_, pos, event.motion.y) &&
+                 GetSigned(data_, pos, event.motion.xrel) &&
+                 GetSigned(data_, pos, event.motion.yrel);
+            break;
+
+        case internal::RecordKind::KeyDown:
+        case internal::RecordKind::KeyUp: {
+            const bool down = kind == internal::RecordKind::KeyDown;
+            uint32_t mod;
+            event.type = down ? SDL_KEYDOWN : SDL_KEYUP;
+            event.key.state = down ? SDL_PRESSED : SDL_RELEASED;
+            ok = GetSigned(data_, pos, event.key.keysym.sym) &&
+                 GetVarint(data_, pos, mod) && pos < data_.size();
+            if (!ok) break;
+            event.key.keysym.mod = static_cast<Uint16>(mod);
+            event.key.repeat = data_[pos++];
+            break;
         }
-    
+
+        default:
+            return false;
+    }
+    if (!ok) return false;
+
+    nextTime_ += delta;
+    event.common.timestamp = startTicks_ + nextTime_;
+    next_ = event;
+    cursor_ = pos;
+    hasNext_ = true;
+    return true;
+}
+
+size_t InputReplay::DispatchUntil(uint32_t time) {
+    time_ = std::max(time_, time);
+    size_t dispatched = 0;
+    while (hasNext_ && nextTime_ <= time_) {
+        PollEvents(next_);
+        ReadNext();
+        ++dispatched;
+    }
+    return dispatched;
+}
+
+size_t InputReplay::Step(uint32_t ms) {
+    return DispatchUntil(time_ + ms);
+}
+
+size_t InputReplay::Update() {
+    const uint64_t now = NowNs();
+    // 首次调用时对齐墙钟，从当前进度继续
+    if (wallStartNs_ == 0) wallStartNs_ = now - static_cast<uint64_t>(time_) * 1000000;
+    return DispatchUntil(static_cast<uint32_t>((now - wallStartNs_) / 1000000));
+}
+
+size_t InputReplay::DispatchAll() {
+    return DispatchUntil(duration_);
 }
 
-void AddListener(EventType type, EventCallback callback) {
-    internal::eventListeners[type].push_back(callback);
+void InputReplay::Rewind() {
+    cursor_ = internal::kRecordHeaderSize;
+    time_ = 0;
+    nextTime_ = 0;
+    wallStartNs_ = 0;
+    ReadNext();
 }
 
 bool IsKeyPressed(KeyCode key) {
-    return internal::keyStates[key];
+    return internal::keyStates[static_cast<size_t>(key)];
 }
 
 bool IsMouseButtonPressed(MouseButton button) {
-    return internal::mouseButtonStates[button];
+    return internal::mouseButtonStates[static_cast<size_t>(button)];
 }
 
 Point GetMousePosition() {
@@ -0,0 +1,517 @@
+// libGfx 内部接口：仅供库内各翻译单元共享，不随 include/ 安装
+
+#ifndef NEBULAXLIBGFX_INTERNAL_H
+#define NEBULAXLIBGFX_INTERNAL_H
+
+#include "../include/libGfx.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace gfx
+{
+// 定义在 libGfx.cpp
+bool IsRenderThread();
+void VerifyRenderThread();
+
+namespace internal
+{
+
+/// @brief Shadow copy of the GL bindings the renderer touches.
+/// @note Every setter compares against the cached value and skips the GL call
+///       when nothing would change. All GL state changes made by the library
+///       must go through here, otherwise the shadow copy goes stale; call
+///       Invalidate() after foreign code touched the context.
+class GLStateCache
+{
+ public:
+  static constexpr GLuint kMaxTextureUnits = 8;
+
+  void UseProgram(GLuint program);
+  void BindVertexArray(GLuint vao);
+  /// @brief Binds @p texture to @p unit and leaves @p unit active, so the
+  ///        caller may edit the texture through GL_TEXTURE_2D afterwards
+  void BindTexture(GLuint unit, GLuint texture);
+  void SetBlendMode(BlendMode mode);
+  void BindFramebuffer(GLuint framebuffer);
+  /// @brief Currently bound framebuffer (queried from GL when unknown)
+  GLuint BoundFramebuffer();
+
+  // 以下 uniform 均作用于当前程序
+  void Uniform1i(GLint location, GLint value);
+  void Uniform1f(GLint location, float value);
+  void Uniform2f(GLint location, float x, float y);
+  void Uniform4f(GLint location, float x, float y, float z, float w);
+  void UniformMatrix4fv(GLint location, const float* value);
+
+  /// @brief Forgets a texture name before it is deleted (names are recycled)
+  /// @note Also bumps the share group's deletion count, so the other
+  ///       contexts drop their cached texture bindings on their next bind
+  void OnTextureDeleted(GLuint texture);
+  /// @brief Tracks the deletion count of the share group whose texture names
+  ///        this context sees (nullptr when leaving the group)
+  void ShareTextureNames(std::atomic<uint32_t>* deletions);
+  /// @brief Forgets a framebuffer name before it is deleted
+  void OnFramebufferDeleted(GLuint framebuffer);
+  /// @brief Forgets a program and its cached uniform values
+  void OnProgramDeleted(GLuint program);
+  /// @brief Marks all cached state unknown so the next setters always issue
+  void Invalidate();
+
+  GLStateStats stats;
+
+ private:
+  static constexpr GLuint kUnknown = 0xFFFFFFFFu;
+
+  // uniform 值按位存储，整型与浮点共用同一槽位
+  struct UniformValue
+  {
+    uint32_t data[16];
+    uint8_t size = 0;  // 0 表示未知
+  };
+  using UniformTable = std::vector<UniformValue>;
+
+  bool UniformUnchanged(GLint location, const void* value, uint8_t size);
+
+  GLuint program_ = kUnknown;
+  GLuint vao_ = kUnknown;
+  GLuint framebuffer_ = kUnknown;
+  GLuint activeUnit_ = kUnknown;
+  std::array<GLuint, kMaxTextureUnits> textures_ = MakeUnknownUnits();
+  std::atomic<uint32_t>* sharedDeletions_ = nullptr;
+  uint32_t seenDeletions_ = 0;  // 上次同步 textures_ 时的组内删除计数
+  BlendMode blend_ = BlendMode::Alpha;
+  bool blendKnown_ = false;
+
+  std::unordered_map<GLuint, UniformTable> uniforms_;
+  UniformTable* currentUniforms_ = nullptr;
+
+  static std::array<GLuint, kMaxTextureUnits> MakeUnknownUnits()
+  {
+    std::array<GLuint, kMaxTextureUnits> units;
+    units.fill(kUnknown);
+    return units;
+  }
+};
+
+/// @brief Ring buffer for all per-frame dynamic geometry.
+/// @note The ring is split into regions; a fence is placed behind a region
+///       once the draws reading it have been issued, and the writer waits on
+///       that fence before reusing the region. With persistent mapping the
+///       CPU writes straight into GPU-visible memory; without
+///       ARB_buffer_storage regions are mapped UNSYNCHRONIZED; without
+///       ARB_sync the buffer is orphaned on wrap instead.
+class StreamBuffer
+{
+ public:
+  struct Region
+  {
+    void* data;       ///< CPU write pointer
+    GLintptr offset;  ///< Byte offset inside the GL buffer
+  };
+
+  bool Create(GLsizeiptr size);
+  void Destroy();
+
+  /// @brief Reserves @p bytes aligned to @p alignment (any positive value,
+  ///        e.g. a vertex stride). Must be followed by Commit() before the
+  ///        next Map(); bytes must not exceed MaxAllocation()
+  /// @note All data read by one draw must come from a single Map(): a wrap
+  ///       in Orphan mode detaches everything written before it
+  Region Map(GLsizeiptr bytes, GLsizeiptr alignment);
+  void Commit();
+  /// @brief Map + memcpy + Commit
+  GLintptr Upload(const void* data, GLsizeiptr bytes, GLsizeiptr alignment);
+
+  /// @brief Fences the regions left behind by earlier Map() calls; call
+  ///        after issuing each draw that reads mapped data
+  void FenceWritten();
+
+  /// @brief Latches this frame's counters; call once per Present
+  void EndFrame();
+
+  GLuint Buffer() const { return buffer_; }
+  GLsizeiptr MaxAllocation() const { return regionSize_; }
+  const StreamStats& LastFrameStats() const { return lastFrame_; }
+
+ private:
+  static constexpr size_t kRegions = 4;
+
+  void WaitRegion(size_t region);
+
+  GLuint buffer_ = 0;
+  StreamMode mode_ = StreamMode::Orphan;
+  GLsizeiptr size_ = 0;
+  GLsizeiptr regionSize_ = 0;
+  GLsizeiptr head_ = 0;
+  uint8_t* persistent_ = nullptr;   // Persistent 模式下的常驻映射
+  std::vector<uint8_t> staging_;    // Orphan 模式下的 CPU 暂存
+  GLsync fences_[kRegions] = {};
+  bool written_[kRegions] = {};     // 当前一轮写入、尚未离开的区域
+  bool retired_[kRegions] = {};     // 已离开、等待绘制发出后加栅栏的区域
+  size_t currentRegion_ = 0;
+  GLintptr pendingOffset_ = 0;
+  GLsizeiptr pendingBytes_ = 0;
+  StreamStats frame_;
+  StreamStats lastFrame_;
+};
+
+/// @brief Dynamic geometry ring buffer of the render thread's context
+StreamBuffer& Stream();
+
+/// @brief State cache of the render thread's GL context
+GLStateCache& GLState();
+
+/// @brief Flushes pending batches that may sample @p texture, then deletes it
+void DeleteTexture(GLuint texture);
+
+// ---------------- 纹理加载（TextureLoader.cpp） ----------------
+/// @brief Loads an image file as an RGBA32 surface (any thread)
+/// @return nullptr on failure (logged); the caller frees the surface
+SDL_Surface* DecodeImage(const std::string& path);
+/// @brief Creates a GL_TEXTURE_2D from tightly packed RGBA8 pixels, staging
+///        the copy through @p pixelBuffer when it is non-zero
+/// @return Texture name, or 0 on GL error
+GLuint UploadTextureRGBA(const void* pixels, int width, int height,
+                         GLuint pixelBuffer = 0);
+/// @brief Cache and async-load bookkeeping of a Texture, created on demand
+///        and freed with it
+struct TextureRecord
+{
+  std::atomic<GLuint> id{0};  // 其它线程读取的名字（加载中为占位纹理）
+  std::atomic<TextureState> state{TextureState::Ready};
+  std::atomic<GLsync> fence{nullptr};  // 组内其它上下文首次使用前等待
+  uint64_t uploader = 0;  // 上传所在上下文的 serial，先于 fence 写入
+  uint32_t refs = 0;      // 路径缓存的引用数，由组互斥量保护
+};
+
+struct TextureAccess
+{
+  static TextureRecord*& Record(const Texture& tex)
+  {
+    return const_cast<Texture&>(tex).record_;
+  }
+};
+
+/// @brief Record of @p tex, created on first use
+TextureRecord& RecordOf(Texture* tex);
+/// @brief Load state of @p tex (Ready for textures without a record)
+TextureState StateOf(const Texture* tex);
+
+/// @brief Fences the upload just issued for @p tex so other contexts of the
+///        share group can wait for it; call before publishing @p tex
+void FenceTextureUpload(Texture* tex, GLuint textureID);
+/// @brief Name to bind for @p tex in the current context, after making the
+///        GPU wait for an upload issued by another context of the group
+GLuint AcquireTexture(const Texture* tex);
+/// @brief Abandons the in-flight asynchronous load of @p tex (~Texture)
+/// @return True when @p tex owns its id, false while it still names the
+///         shared placeholder
+bool CancelTextureLoad(const Texture* tex);
+/// @brief Drops @p tex from the path cache if it is an entry (~Texture)
+void ForgetCachedTexture(const Texture* tex);
+/// @brief Joins decode workers and releases the async loader's GL objects
+///        (Shutdown; cached textures go with their share group)
+void ShutdownTextureLoader();
+
+// ---------------- 资源包（AssetPack.cpp） ----------------
+/// @brief Uploads @p name from the most recently mounted pack containing it
+/// @return nullptr when no mounted pack has the entry
+Texture* LoadFromMountedPacks(const std::string& name);
+
+/// @brief Drops queued async tasks and command lists (Shutdown)
+void DiscardAsyncWork();
+
+// ---------------- 着色器（Shader.cpp） ----------------
+/// @brief Links a program from source, going through the on-disk program
+///        binary cache when the driver supports it
+/// @param linked Receives the link status when non-null
+/// @return Program name; compile/link errors are logged and the (unusable)
+///         program is still returned, like glLinkProgram would
+GLuint BuildProgram(const char* vsSrc, const char* fsSrc,
+                    bool* linked = nullptr);
+
+/// @brief Window of the current context (nullptr when headless)
+SDL_Window* Window();
+/// @brief Size of the default render target in screen units
+void TargetSize(int* width, int* height);
+/// @brief Size of the default render target in pixels
+void DrawableSize(int* width, int* height);
+/// @brief Everything context creation does once the new GL context is
+///        current: GLEW, programs, buffers, viewport and projection for a
+///        @p width x @p height target
+bool InitRendererState(int width, int height);
+
+// ---------------- 无窗口渲染（Headless.cpp） ----------------
+bool IsHeadless();
+/// @return false when not headless; otherwise the offscreen target size
+bool HeadlessSize(int* width, int* height);
+/// @brief Starts the asynchronous readback of the finished frame (Present)
+void QueueHeadlessReadback();
+/// @brief Deletes the offscreen target and the GL context of the current
+///        headless context (~RenderContext)
+void ShutdownHeadless();
+
+// ---------------- 脏区跟踪（Damage.cpp） ----------------
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+/// @brief 64-bit FNV-1a; chain calls by passing the previous result as seed
+uint64_t HashBytes(const void* data, size_t size,
+                   uint64_t seed = kFnvOffsetBasis);
+
+DamageMode CurrentDamageMode();
+/// @brief Culling test for a draw covering @p bounds (screen coordinates);
+///        false only in Manual mode when it misses the frame's damage
+bool DamageVisible(const Rect& bounds);
+/// @brief Records a draw for Auto-mode diffing (no-op in other modes)
+void DamageRecord(const Rect& bounds, uint64_t signature);
+/// @brief DamageRecord + DamageVisible; @p signature is only evaluated in
+///        Auto mode
+template <typename SignatureFn>
+bool DamageTest(const Rect& bounds, SignatureFn&& signature)
+{
+  switch (CurrentDamageMode())
+  {
+    case DamageMode::Off:
+      return true;
+    case DamageMode::Auto:
+      DamageRecord(bounds, signature());
+      return true;
+    case DamageMode::Manual:
+      break;
+  }
+  return DamageVisible(bounds);
+}
+/// @brief Clips the next GL draw or clear to the damage (Manual mode)
+void ApplyDamageScissor();
+/// @brief Offscreen targets are never clipped, culled or diffed
+///        (Framebuffer::Bind/Unbind)
+void PushOffscreenTarget();
+void PopOffscreenTarget();
+/// @brief Closes the frame's bookkeeping (Present)
+/// @return false if the swap may be skipped
+bool EndDamageFrame();
+
+#ifdef GFX_ENABLE_PROFILER
+// ---------------- 性能剖析（Profiler.cpp） ----------------
+/// @brief Latches the frame's counters and collects finished GPU timer
+///        queries (end of Present)
+void ProfilerEndFrame();
+/// @brief Deletes timer queries while the context is still current (Shutdown)
+void ProfilerShutdown();
+#endif
+
+// ---------------- 批处理入口 ----------------
+/// 预变换后的批处理顶点：屏幕坐标 + 纹理坐标 + 颜色
+struct BatchVertex
+{
+  float x, y;
+  float u, v;
+  uint8_t r, g, b, a;
+};
+
+// 16 位索引可寻址的最大顶点数
+constexpr size_t kMaxBatchVertices = 65536;
+
+/// @brief Space reserved in the batch; indices written by the caller are
+///        absolute, i.e. @c base plus the local vertex number
+struct BatchAllocation
+{
+  BatchVertex* vertices;
+  GLushort* indices;
+  GLushort base;
+};
+
+/// @brief Reserves room for raw triangles sampling @p texture, flushing on
+///        texture change or when the vertex buffer would overflow
+/// @note vertexCount must not exceed kMaxBatchVertices; the pointers stay
+///       valid until the next allocation or flush
+BatchAllocation AllocateBatch(GLuint texture, size_t vertexCount,
+                              size_t indexCount);
+/// @brief 1x1 white texture used for untextured batched geometry
+GLuint WhiteTexture();
+
+/// @brief Appends a textured quad to the batch regardless of batching mode;
+///        callers outside batching mode must FlushBatch() when done
+void PushQuad(GLuint texture, const Rect& dest, float u0, float v0, float u1,
+              float v1, Color color, float rotation = 0.0f);
+void FlushBatch(FlushReason reason);
+
+/// @brief Shelf (row) rectangle packer: places rects left to right on
+///        horizontal shelves and opens a new shelf below when none fits
+class ShelfPacker
+{
+ public:
+  ShelfPacker(int width = 0, int height = 0) { Reset(width, height); }
+
+  void Reset(int width, int height);
+  /// @return false when the page has no room left for a w x h rect
+  bool Pack(int w, int h, int& x, int& y);
+
+  int Width() const { return width_; }
+  int Height() const { return height_; }
+
+ private:
+  struct Shelf
+  {
+    int y, height, cursorX;
+  };
+  std::vector<Shelf> shelves_;
+  int width_ = 0, height_ = 0;
+  int nextY_ = 0;
+};
+
+/// @brief RGBA texture pages filled through a ShelfPacker (used by Font)
+/// @note Pages carry a last-use tick; once the byte budget is reached no new
+///       page is allocated and the caller evicts the least recently used one
+class GlyphAtlas
+{
+ public:
+  GlyphAtlas(int pageSize, size_t budgetBytes)
+      : pageSize_(pageSize)
+  {
+    SetBudget(budgetBytes);
+  }
+  ~GlyphAtlas();
+
+  /// @brief Copies a w x h RGBA bitmap into a page, allocating a new page
+  ///        when the current ones are full and the budget allows
+  /// @return false if no page has room (or the bitmap exceeds a page)
+  bool Insert(const uint8_t* rgba, int w, int h, GLuint& texture, float& u0,
+              float& v0, float& u1, float& v1);
+  /// @brief Marks the page owning @p texture as most recently used
+  void Touch(GLuint texture);
+  /// @brief Clears the least recently used page for reuse
+  /// @return Its texture, whose glyphs the owner must forget (0 if no pages)
+  GLuint EvictLeastRecentlyUsed();
+  /// @brief Deletes least recently used pages beyond the budget
+  /// @return Textures of the removed pages
+  std::vector<GLuint> SetBudget(size_t bytes);
+
+  size_t PageCount() const { return pages_.size(); }
+  size_t PageBytes() const
+  {
+    return static_cast<size_t>(pageSize_) * pageSize_ * 4;
+  }
+
+ private:
+  struct Page
+  {
+    GLuint texture = 0;
+    ShelfPacker packer;
+    uint64_t lastUse = 0;
+  };
+  bool AddPage();
+  size_t LeastRecentlyUsed() const;
+
+  std::vector<Page> pages_;
+  int pageSize_;
+  size_t maxPages_ = 1;
+  uint64_t tick_ = 0;
+};
+
+// ---------------- 渲染上下文（libGfx.cpp） ----------------
+// 以下状态由各自的翻译单元按需创建，删除器随定义放在同一文件
+struct DamageState;    // Damage.cpp
+struct HeadlessState;  // Headless.cpp
+struct ShareGroup;     // TextureLoader.cpp：共享组内的纹理路径缓存
+
+struct DamageStateDeleter
+{
+  void operator()(DamageState* state) const;
+};
+struct HeadlessStateDeleter
+{
+  void operator()(HeadlessState* state) const;
+};
+
+/// 主着色器在 Init 时缓存的 uniform 位置
+struct MainUniforms
+{
+  GLint projection = -1;
+  GLint model = -1;
+  GLint uvRect = -1;
+  GLint color = -1;
+  GLint useTexture = -1;
+  GLint texture1 = -1;
+};
+
+struct BatchState
+{
+  bool enabled = false;
+  GLuint texture = 0;
+  std::vector<BatchVertex> vertices;
+  std::vector<GLushort> indices;
+  BatchStats frameStats;      // 当前帧累计
+  BatchStats lastFrameStats;  // 上一帧（Present 时锁存）
+};
+
+/// @brief Everything a RenderContext owns
+/// @note Only touched by the thread the context is current on, except
+///       @c thread, which RenderContext::MakeCurrent guards with a mutex
+struct ContextState
+{
+  RenderContext* owner = nullptr;
+  uint64_t serial = 0;  // 进程内唯一，地址会被复用；占位状态为 0
+  SDL_Window* window = nullptr;  // nullptr when headless
+  SDL_GLContext glContext = nullptr;
+  std::thread::id thread;        // 当前绑定的线程，未绑定时为默认值
+  bool glewInitialized = false;
+  std::shared_ptr<ShareGroup> shareGroup;
+
+  glm::mat4 projection{1.0f};
+  BlendMode blendMode = BlendMode::Alpha;
+  GLStateCache glState;
+  StreamBuffer stream;  // 所有动态几何共用的环形缓冲
+  MainUniforms uniforms;
+  BatchState batch;
+
+  GLuint quadVAO = 0, quadVBO = 0;
+  GLuint shaderProgram = 0;
+  GLuint batchVAO = 0;
+  GLuint batchProgram = 0;
+  GLint batchProjLoc = -1;
+  GLuint whiteTexture = 0;  // 1x1 白色纹理，使纯色矩形可以和纹理四边形合批
+  // instanceVAO 复用 quadVBO 的单位四边形，逐实例属性来自环形缓冲
+  GLuint instanceVAO = 0;
+  GLuint instanceProgram = 0;
+  GLint instanceProjLoc = -1;
+
+  std::unordered_map<FontKey, Font*> fontCache;
+  std::unique_ptr<DamageState, DamageStateDeleter> damage;
+  std::unique_ptr<HeadlessState, HeadlessStateDeleter> headless;
+};
+
+/// @brief State of the context current on the calling thread; an inert
+///        placeholder without GL objects when there is none
+ContextState& Ctx();
+/// @brief True when the calling thread's current context is the default one
+///        (Renderer::Init/InitHeadless), which alone runs the async texture
+///        loader and the profiler's GPU timers
+bool IsDefaultContext();
+
+/// @brief Attaches @p ctx to the share group of @p shareWith, or to a new
+///        group when it is nullptr
+void JoinShareGroup(ContextState& ctx, const ContextState* shareWith);
+/// @brief Detaches @p ctx (current) from its group; the last context of a
+///        group frees the group's cached textures
+void LeaveShareGroup(ContextState& ctx);
+
+// ---------------- 无窗口上下文（Headless.cpp） ----------------
+/// @brief Creates @p ctx's offscreen GL context (EGL, or a hidden SDL window
+///        when EGL is unavailable or @p shareWith has a window) without
+///        making it current; sets ctx.headless on success
+bool CreateHeadlessContext(ContextState& ctx, const ContextState* shareWith);
+/// @brief Binds (or with @p bind false, unbinds) the headless context's GL
+///        context on the calling thread
+bool MakeHeadlessCurrent(HeadlessState& headless, bool bind);
+/// @brief Creates the current headless context's framebuffer and readback
+///        buffers and sets viewport and projection to @p width x @p height
+bool AllocateHeadlessTarget(int width, int height);
+
+}  // namespace internal
+}  // namespace gfx
+
+#endif  // NEBULAXLIBGFX_INTERNAL_H
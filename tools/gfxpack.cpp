@@ -0,0 +1,263 @@
+// gfxpack：把目录中的图片预解码为 RGBA8（可选预生成 mip 链）写入资源包
+//
+//   gfxpack <input-dir> <output.pack> [--mipmaps] [--prefix <name-prefix>]
+//
+// 条目名 = 前缀 + 相对 input-dir 的路径（'/' 分隔），与 Renderer::LoadTexture
+// 的路径规范化结果一致，挂载后可直接用原路径加载。
+
+#include <SDL2/SDL.h>
+#include <SDL_image.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AssetPackFormat.h"
+
+namespace fs = std::filesystem;
+using namespace gfx;
+
+namespace
+{
+struct Image
+{
+  std::string name;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t mipLevels = 1;
+  std::vector<uint8_t> texels;  // 所有级别紧密排列
+};
+
+bool IsImageFile(const fs::path& path)
+{
+  std::string ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" ||
+         ext == ".tga" || ext == ".gif" || ext == ".webp";
+}
+
+// 2x2 盒式滤波生成下一级；奇数边长时末行/列重复采样
+void Downsample(const uint8_t* src, uint32_t w, uint32_t h, uint8_t* dst)
+{
+  const uint32_t dw = pack::LevelWidth(w, 1), dh = pack::LevelWidth(h, 1);
+  for (uint32_t y = 0; y < dh; ++y)
+  {
+    const uint32_t y0 = std::min(y * 2, h - 1), y1 = std::min(y * 2 + 1, h - 1);
+    for (uint32_t x = 0; x < dw; ++x)
+    {
+      const uint32_t x0 = std::min(x * 2, w - 1),
+                     x1 = std::min(x * 2 + 1, w - 1);
+      for (uint32_t c = 0; c < 4; ++c)
+      {
+        const uint32_t sum = src[(y0 * w + x0) * 4 + c] +
+                             src[(y0 * w + x1) * 4 + c] +
+                             src[(y1 * w + x0) * 4 + c] +
+                             src[(y1 * w + x1) * 4 + c];
+        dst[(y * dw + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+      }
+    }
+  }
+}
+
+bool Decode(const fs::path& file, bool mipmaps, Image& image)
+{
+  SDL_Surface* surface = IMG_Load(file.string().c_str());
+  if (!surface)
+  {
+    std::cerr << "Failed to load image: " << file << " - " << IMG_GetError()
+              << std::endl;
+    return false;
+  }
+  SDL_Surface* converted =
+      SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+  SDL_FreeSurface(surface);
+  if (!converted)
+  {
+    std::cerr << "Failed to convert image: " << file << std::endl;
+    return false;
+  }
+
+  image.width = static_cast<uint32_t>(converted->w);
+  image.height = static_cast<uint32_t>(converted->h);
+  if (image.width > pack::kMaxDimension || image.height > pack::kMaxDimension)
+  {
+    std::cerr << "Image too large: " << file << std::endl;
+    SDL_FreeSurface(converted);
+    return false;
+  }
+  image.mipLevels =
+      mipmaps ? pack::MaxMipLevels(image.width, image.height) : 1;
+
+  uint64_t total = 0;
+  for (uint32_t level = 0; level < image.mipLevels; ++level)
+    total += pack::LevelBytes(image.width, image.height, level);
+  image.texels.resize(total);
+
+  // 去掉 surface 的行填充
+  const size_t rowBytes = size_t(image.width) * 4;
+  for (uint32_t y = 0; y < image.height; ++y)
+  {
+    std::memcpy(&image.texels[y * rowBytes],
+                static_cast<const uint8_t*>(converted->pixels) +
+                    size_t(y) * converted->pitch,
+                rowBytes);
+  }
+  SDL_FreeSurface(converted);
+
+  uint8_t* level = image.texels.data();
+  for (uint32_t i = 1; i < image.mipLevels; ++i)
+  {
+    uint8_t* next = level + pack::LevelBytes(image.width, image.height, i - 1);
+    Downsample(level, pack::LevelWidth(image.width, i - 1),
+               pack::LevelWidth(image.height, i - 1), next);
+    level = next;
+  }
+  return true;
+}
+
+bool WritePack(const std::string& output, std::vector<Image>& images)
+{
+  std::sort(images.begin(), images.end(),
+            [](const Image& a, const Image& b) { return a.name < b.name; });
+
+  pack::Header header{};
+  std::memcpy(header.magic, pack::kMagic, sizeof pack::kMagic);
+  header.version = pack::kVersion;
+  header.entryCount = static_cast<uint32_t>(images.size());
+  header.indexOffset = sizeof(pack::Header);
+  header.namesOffset =
+      header.indexOffset + images.size() * sizeof(pack::Entry);
+
+  std::string names;
+  std::vector<pack::Entry> entries(images.size());
+  for (size_t i = 0; i < images.size(); ++i)
+  {
+    entries[i].nameOffset = names.size();
+    entries[i].nameLength = static_cast<uint32_t>(images[i].name.size());
+    names += images[i].name;
+  }
+  header.namesSize = names.size();
+
+  uint64_t offset = header.namesOffset + header.namesSize;
+  for (size_t i = 0; i < images.size(); ++i)
+  {
+    pack::Entry& e = entries[i];
+    offset = pack::AlignUp(offset, pack::kDataAlignment);
+    e.format = static_cast<uint32_t>(pack::TexelFormat::RGBA8);
+    e.width = images[i].width;
+    e.height = images[i].height;
+    e.mipLevels = images[i].mipLevels;
+    e.dataOffset = offset;
+    e.dataSize = images[i].texels.size();
+    offset += e.dataSize;
+  }
+
+  // 先写临时文件再改名，运行中的程序不会映射到半个包
+  const std::string tmp = output + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+      std::cerr << "Failed to create " << tmp << std::endl;
+      return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof header);
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              entries.size() * sizeof(pack::Entry));
+    out.write(names.data(), names.size());
+    static const char zeros[pack::kDataAlignment] = {};
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+      const uint64_t pos = static_cast<uint64_t>(out.tellp());
+      out.write(zeros, entries[i].dataOffset - pos);
+      out.write(reinterpret_cast<const char*>(images[i].texels.data()),
+                images[i].texels.size());
+    }
+    if (!out)
+    {
+      std::cerr << "Failed to write " << tmp << std::endl;
+      return false;
+    }
+  }
+  std::error_code ec;
+  fs::rename(tmp, output, ec);
+  if (ec)
+  {
+    std::cerr << "Failed to rename " << tmp << ": " << ec.message()
+              << std::endl;
+    fs::remove(tmp, ec);
+    return false;
+  }
+  return true;
+}
+
+void PrintUsage()
+{
+  std::cerr << "Usage: gfxpack <input-dir> <output.pack> [--mipmaps] "
+               "[--prefix <name-prefix>]"
+            << std::endl;
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> positional;
+  bool mipmaps = false;
+  std::string prefix;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--mipmaps")
+      mipmaps = true;
+    else if (arg == "--prefix" && i + 1 < argc)
+      prefix = argv[++i];
+    else
+      positional.push_back(arg);
+  }
+  if (positional.size() != 2)
+  {
+    PrintUsage();
+    return 1;
+  }
+
+  const fs::path input = positional[0];
+  std::error_code ec;
+  if (!fs::is_directory(input, ec))
+  {
+    std::cerr << "Not a directory: " << input << std::endl;
+    return 1;
+  }
+
+  IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+
+  std::vector<Image> images;
+  size_t failed = 0;
+  for (const fs::directory_entry& entry :
+       fs::recursive_directory_iterator(input))
+  {
+    if (!entry.is_regular_file() || !IsImageFile(entry.path())) continue;
+
+    Image image;
+    image.name = prefix + fs::relative(entry.path(), input)
+                              .lexically_normal()
+                              .generic_string();
+    if (Decode(entry.path(), mipmaps, image))
+      images.push_back(std::move(image));
+    else
+      ++failed;
+  }
+
+  IMG_Quit();
+
+  const bool ok = WritePack(positional[1], images);
+  std::cout << "Packed " << images.size() << " images into " << positional[1]
+            << (failed ? " (" + std::to_string(failed) + " failed)" : "")
+            << std::endl;
+  return ok && failed == 0 ? 0 : 1;
+}